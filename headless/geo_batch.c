@@ -0,0 +1,528 @@
+/*
+Copyright (c) 2026 Rupert Carmichael
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Headless batch runner
+
+   Runs a number of instances of a cartridge title without a frontend, each
+   driven by its own input script, writing periodic state hashes and optional
+   state snapshots. The emulator core keeps its machine state in process-wide
+   globals, so a process can only host one machine, and instances are spread
+   across forked worker processes rather than threads. The ROM data is loaded
+   before forking, so every worker shares one copy of it through copy-on-write
+   pages.
+
+   The runner is POSIX only: it needs fork(), wait(), getopt(), sysconf() and
+   clock_gettime(), and does not build on Windows. A portable thread pool
+   (rthreads) needs the core's state to move into a per-machine context first.
+
+   Input scripts are plain text, one event per line:
+     <frame> <input> <value>
+   where input is one of p1, p2, stat_a, stat_b, systype, dipsw or sys, and
+   value is the raw active-low register value (decimal, or hex with 0x). A
+   value holds from the given frame until it is changed. Lines beginning with
+   '#' are ignored.
+
+   Each instance can instead record its run to an input movie, or play one
+   back in place of an input script, optionally seeking into it first. Hashes
+   are numbered by movie frame, so a playback can be checked against the
+   hashes of the run which recorded it.
+*/
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "geo.h"
+#include "geo_hash.h"
+#include "geo_lspc.h"
+#include "geo_mixer.h"
+#include "geo_movie.h"
+#include "geo_neo.h"
+#include "geo_vfs.h"
+
+#define NUMSOURCES (NUMINPUTS_NG + NUMINPUTS_SYS)
+
+typedef struct _batch_event_t {
+    uint32_t frame;
+    unsigned src;
+    unsigned val;
+    unsigned line; // Script line, so later lines win within a frame
+} batch_event_t;
+
+typedef struct _batch_opts_t {
+    const char *bios;
+    const char *rom;
+    const char *inputs; // Input script path pattern, %d is the instance index
+    const char *movrec; // Movie to record, same pattern
+    const char *movplay; // Movie to play back, same pattern
+    const char *outdir;
+    int sys;
+    int region;
+    unsigned instances;
+    unsigned workers;
+    uint32_t frames;
+    uint32_t seek; // Movie frame to seek to before running
+    uint32_t hashint;
+    uint32_t snapint;
+    unsigned render;
+} batch_opts_t;
+
+static const char *srcnames[NUMSOURCES] = {
+    "p1", "p2", "stat_a", "stat_b", "systype", "dipsw", "sys"
+};
+
+static unsigned inputs[NUMSOURCES]; // Current value of each input source
+
+static uint32_t *vbuf = NULL;
+static int16_t *abuf = NULL;
+
+static void batch_log(int level, const char *fmt, ...) {
+    if (level < GEO_LOG_WRN)
+        return;
+
+    va_list va;
+    va_start(va, fmt);
+    vfprintf(stderr, fmt, va);
+    va_end(va);
+}
+
+static unsigned batch_input_cb(unsigned port) {
+    return inputs[port];
+}
+
+static unsigned batch_input_sys0(void) { return inputs[NUMINPUTS_NG + 0]; }
+static unsigned batch_input_sys1(void) { return inputs[NUMINPUTS_NG + 1]; }
+static unsigned batch_input_sys2(void) { return inputs[NUMINPUTS_NG + 2]; }
+static unsigned batch_input_sys3(void) { return inputs[NUMINPUTS_NG + 3]; }
+static unsigned batch_input_sys4(void) { return inputs[NUMINPUTS_NG + 4]; }
+
+static void batch_audio_cb(size_t samps) {
+    (void)samps; // Audio is generated to keep timing exact, then discarded
+}
+
+// Idle values for every input, matching an unattended machine
+static void batch_input_defaults(int sys) {
+    inputs[0] = inputs[1] = 0xff;
+    inputs[NUMINPUTS_NG + 0] = sys == SYSTEM_MVS ? 0x1f : 0x07; // Status A
+    inputs[NUMINPUTS_NG + 1] = 0x3f; // Status B, no memory card
+    inputs[NUMINPUTS_NG + 2] = 0xc0; // System Type
+    inputs[NUMINPUTS_NG + 3] = 0xff; // DIP Switches
+    inputs[NUMINPUTS_NG + 4] = 0xff; // V-Liner System Buttons
+}
+
+static int batch_event_cmp(const void *a, const void *b) {
+    const batch_event_t *ea = (const batch_event_t*)a;
+    const batch_event_t *eb = (const batch_event_t*)b;
+    if (ea->frame != eb->frame)
+        return (ea->frame > eb->frame) - (ea->frame < eb->frame);
+    return (ea->line > eb->line) - (ea->line < eb->line);
+}
+
+// Parse an input script, returning the number of events or -1 on failure
+static int batch_script_load(const char *path, batch_event_t **events) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        fprintf(stderr, "Cannot open input script %s\n", path);
+        return -1;
+    }
+
+    char line[256];
+    size_t n = 0, cap = 0;
+    unsigned lineno = 0;
+    *events = NULL;
+
+    while (fgets(line, sizeof(line), fp)) {
+        char name[32];
+        char valstr[32];
+        unsigned long frame;
+        ++lineno;
+
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r')
+            continue;
+
+        if (sscanf(line, "%lu %31s %31s", &frame, name, valstr) != 3) {
+            fprintf(stderr, "%s:%u: malformed event\n", path, lineno);
+            continue;
+        }
+
+        unsigned src = 0;
+        while (src < NUMSOURCES && strcmp(name, srcnames[src]))
+            ++src;
+
+        if (src == NUMSOURCES) {
+            fprintf(stderr, "%s:%u: unknown input %s\n", path, lineno, name);
+            continue;
+        }
+
+        if (n == cap) {
+            cap = cap ? cap << 1 : 256;
+            batch_event_t *newev =
+                (batch_event_t*)realloc(*events, cap * sizeof(batch_event_t));
+            if (!newev) {
+                free(*events);
+                fclose(fp);
+                return -1;
+            }
+            *events = newev;
+        }
+
+        (*events)[n].frame = frame;
+        (*events)[n].src = src;
+        (*events)[n].val = strtoul(valstr, NULL, 0) & 0xff;
+        (*events)[n].line = lineno;
+        ++n;
+    }
+
+    fclose(fp);
+
+    qsort(*events, n, sizeof(batch_event_t), batch_event_cmp);
+    return (int)n;
+}
+
+static double batch_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + (ts.tv_nsec / 1000000000.0);
+}
+
+// Run a single instance from the pristine state
+static int batch_run_instance(const batch_opts_t *opts, unsigned inst,
+    const uint8_t *pristine) {
+
+    char path[1024];
+    batch_event_t *events = NULL;
+    int nevents = 0;
+
+    if (opts->inputs) {
+        snprintf(path, sizeof(path), opts->inputs, inst);
+        nevents = batch_script_load(path, &events);
+        if (nevents < 0)
+            return 0;
+    }
+
+    snprintf(path, sizeof(path), "%s/inst%u.hash", opts->outdir, inst);
+    FILE *hashfp = fopen(path, "w");
+    if (!hashfp) {
+        fprintf(stderr, "Cannot create %s\n", path);
+        free(events);
+        return 0;
+    }
+
+    uint32_t first = 0;
+
+    if (opts->movplay) {
+        // The movie carries its own starting state and input
+        snprintf(path, sizeof(path), opts->movplay, inst);
+        if (!geo_movie_play(path)) {
+            fprintf(stderr, "Cannot play movie %s\n", path);
+            fclose(hashfp);
+            return 0;
+        }
+
+        if (opts->seek) {
+            if (!geo_movie_seek(opts->seek)) {
+                fprintf(stderr, "Cannot seek %s to frame %u\n", path,
+                    opts->seek);
+                geo_movie_stop();
+                fclose(hashfp);
+                return 0;
+            }
+            geo_lspc_set_skip_render(!opts->render);
+            first = geo_movie_frame();
+        }
+    }
+    else {
+        batch_input_defaults(opts->sys);
+        geo_state_load_raw(pristine);
+
+        if (opts->movrec && !geo_movie_record(GEO_MOVIE_KEYFRAME_INTERVAL)) {
+            fprintf(stderr, "Cannot record movie for instance %u\n", inst);
+            fclose(hashfp);
+            free(events);
+            return 0;
+        }
+    }
+
+    int ev = 0;
+    uint32_t ran = 0;
+    double start = batch_time();
+
+    for (uint32_t frame = first; frame < opts->frames; ++frame) {
+        if (opts->movplay && frame >= geo_movie_length())
+            break; // Nothing left to play back
+
+        while (ev < nevents && events[ev].frame <= frame) {
+            inputs[events[ev].src] = events[ev].val;
+            ++ev;
+        }
+
+        geo_exec();
+        ++ran;
+
+        if (opts->hashint && !((frame + 1) % opts->hashint)) {
+            geo_hash_t hash;
+            geo_state_hash(&hash);
+            fprintf(hashfp, "%u %016llx", frame + 1,
+                (unsigned long long)hash.combined);
+            for (unsigned i = 0; i < GEO_HASH_MAX; ++i)
+                fprintf(hashfp, " %016llx", (unsigned long long)hash.subsys[i]);
+            fputc('\n', hashfp);
+        }
+
+        if (opts->snapint && !((frame + 1) % opts->snapint)) {
+            snprintf(path, sizeof(path), "%s/inst%u_%u.sta", opts->outdir,
+                inst, frame + 1);
+            if (!geo_state_save(path))
+                fprintf(stderr, "Cannot write snapshot %s\n", path);
+        }
+    }
+
+    double elapsed = batch_time() - start;
+    fclose(hashfp);
+    free(events);
+
+    int ret = 1;
+    if (opts->movrec) {
+        snprintf(path, sizeof(path), opts->movrec, inst);
+        if (!geo_movie_save(path)) {
+            fprintf(stderr, "Cannot write movie %s\n", path);
+            ret = 0;
+        }
+    }
+    geo_movie_stop();
+
+    printf("instance %u: %u frames in %.3fs (%.1f fps)\n", inst, ran,
+        elapsed, elapsed > 0.0 ? ran / elapsed : 0.0);
+    fflush(stdout);
+
+    return ret;
+}
+
+static int batch_worker(const batch_opts_t *opts, unsigned worker,
+    const uint8_t *pristine) {
+
+    int ret = 1;
+    for (unsigned inst = worker; inst < opts->instances; inst += opts->workers)
+        ret &= batch_run_instance(opts, inst, pristine);
+    return ret;
+}
+
+static void batch_usage(const char *argv0) {
+    fprintf(stderr,
+        "Usage: %s [options] -b bios.zip game.neo\n"
+        "  -b <file>    BIOS archive (aes.zip, neogeo.zip)\n"
+        "  -s <system>  aes, mvs or uni (default mvs)\n"
+        "  -r <region>  us, jp, as or eu (default us)\n"
+        "  -n <count>   Number of instances (default 1)\n"
+        "  -j <count>   Number of worker processes (default: online CPUs)\n"
+        "  -f <frames>  Frames to run per instance (default 3600)\n"
+        "  -h <frames>  State hash interval, 0 to disable (default 60)\n"
+        "  -k <frames>  State snapshot interval, 0 to disable (default 0)\n"
+        "  -i <path>    Input script per instance, %%d expands to the index\n"
+        "  -m <path>    Record an input movie per instance, as for -i\n"
+        "  -p <path>    Play back an input movie per instance instead of a "
+        "script\n"
+        "  -g <frame>   Seek to a movie frame before running (needs -p)\n"
+        "  -o <dir>     Output directory (default .)\n"
+        "  -v           Render video (only useful when timing the renderer)\n",
+        argv0);
+}
+
+static int batch_parse_system(const char *s) {
+    if (!strcmp(s, "aes")) return SYSTEM_AES;
+    if (!strcmp(s, "mvs")) return SYSTEM_MVS;
+    if (!strcmp(s, "uni")) return SYSTEM_UNI;
+    return -1;
+}
+
+static int batch_parse_region(const char *s) {
+    if (!strcmp(s, "us")) return REGION_US;
+    if (!strcmp(s, "jp")) return REGION_JP;
+    if (!strcmp(s, "as")) return REGION_AS;
+    if (!strcmp(s, "eu")) return REGION_EU;
+    return -1;
+}
+
+int main(int argc, char *argv[]) {
+    batch_opts_t opts;
+    memset(&opts, 0, sizeof(opts));
+    opts.outdir = ".";
+    opts.sys = SYSTEM_MVS;
+    opts.region = REGION_US;
+    opts.instances = 1;
+    opts.frames = 3600;
+    opts.hashint = 60;
+
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    opts.workers = ncpu > 0 ? (unsigned)ncpu : 1;
+
+    int c;
+    while ((c = getopt(argc, argv, "b:s:r:n:j:f:h:k:i:m:p:g:o:v")) != -1) {
+        switch (c) {
+            case 'b': opts.bios = optarg; break;
+            case 's': opts.sys = batch_parse_system(optarg); break;
+            case 'r': opts.region = batch_parse_region(optarg); break;
+            case 'n': opts.instances = strtoul(optarg, NULL, 0); break;
+            case 'j': opts.workers = strtoul(optarg, NULL, 0); break;
+            case 'f': opts.frames = strtoul(optarg, NULL, 0); break;
+            case 'h': opts.hashint = strtoul(optarg, NULL, 0); break;
+            case 'k': opts.snapint = strtoul(optarg, NULL, 0); break;
+            case 'i': opts.inputs = optarg; break;
+            case 'm': opts.movrec = optarg; break;
+            case 'p': opts.movplay = optarg; break;
+            case 'g': opts.seek = strtoul(optarg, NULL, 0); break;
+            case 'o': opts.outdir = optarg; break;
+            case 'v': opts.render = 1; break;
+            default: batch_usage(argv[0]); return 1;
+        }
+    }
+
+    if (optind >= argc || !opts.bios || opts.sys < 0 || opts.region < 0 ||
+        !opts.instances || !opts.workers ||
+        (opts.movplay && (opts.inputs || opts.movrec)) ||
+        (opts.seek && !opts.movplay)) {
+        batch_usage(argv[0]);
+        return 1;
+    }
+
+    opts.rom = argv[optind];
+    if (opts.workers > opts.instances)
+        opts.workers = opts.instances;
+
+    if (mkdir(opts.outdir, 0755) && errno != EEXIST) {
+        fprintf(stderr, "Cannot create output directory %s\n", opts.outdir);
+        return 1;
+    }
+
+    geo_log_set_callback(batch_log);
+
+    vbuf = (uint32_t*)calloc(1, LSPC_WIDTH * LSPC_SCANLINES * sizeof(uint32_t));
+    abuf = (int16_t*)calloc(1, 2048 * sizeof(int16_t));
+    if (!vbuf || !abuf)
+        return 1;
+
+    geo_lspc_set_buffer(vbuf);
+    geo_lspc_set_skip_render(!opts.render);
+    geo_mixer_set_buffer(abuf);
+    geo_mixer_set_callback(batch_audio_cb);
+    geo_mixer_init();
+    geo_mixer_set_raw(1);
+
+    geo_set_region(opts.region);
+    geo_set_system(opts.sys);
+    geo_init();
+
+    if (!geo_bios_load_file(opts.bios)) {
+        fprintf(stderr, "Failed to load BIOS %s\n", opts.bios);
+        return 1;
+    }
+
+    // Map the ROM so concurrent runs on one host share its page cache copy
+    size_t romsz = 0;
+    void *rom = geo_vfs_map_file(opts.rom, &romsz);
+    int mapped = rom != NULL;
+    if (!mapped)
+        rom = geo_vfs_read_file(opts.rom, &romsz);
+
+    if (!rom || !geo_neo_load(rom, romsz)) {
+        fprintf(stderr, "Failed to load ROM %s\n", opts.rom);
+        return 1;
+    }
+
+    geo_input_set_callback(0, &batch_input_cb);
+    geo_input_set_callback(1, &batch_input_cb);
+    geo_input_sys_set_callback(0, &batch_input_sys0);
+    geo_input_sys_set_callback(1, &batch_input_sys1);
+    geo_input_sys_set_callback(2, &batch_input_sys2);
+    geo_input_sys_set_callback(3, &batch_input_sys3);
+    geo_input_sys_set_callback(4, &batch_input_sys4);
+
+    // Every instance starts from the same freshly booted machine
+    geo_reset(1);
+    size_t statesz = geo_state_size();
+    uint8_t *pristine = (uint8_t*)malloc(statesz);
+    if (!pristine)
+        return 1;
+    memcpy(pristine, geo_state_save_raw(), statesz);
+
+    double start = batch_time();
+    unsigned failed = 0;
+
+    for (unsigned w = 0; w < opts.workers; ++w) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            int ok = batch_worker(&opts, w, pristine);
+            fflush(stdout);
+            _exit(ok ? 0 : 1);
+        }
+        else if (pid < 0) {
+            fprintf(stderr, "fork failed, running worker %u in process\n", w);
+            failed += !batch_worker(&opts, w, pristine);
+        }
+    }
+
+    int status;
+    while (wait(&status) > 0) {
+        if (!WIFEXITED(status) || WEXITSTATUS(status))
+            ++failed;
+    }
+
+    double elapsed = batch_time() - start;
+    // Frames passed over by a seek are not counted
+    uint32_t ran = opts.frames > opts.seek ? opts.frames - opts.seek : 0;
+    uint64_t total = (uint64_t)ran * opts.instances;
+    printf("%u instances, %u workers: %llu frames in %.3fs (%.1f fps)\n",
+        opts.instances, opts.workers, (unsigned long long)total, elapsed,
+        elapsed > 0.0 ? total / elapsed : 0.0);
+
+    free(pristine);
+    geo_movie_deinit();
+    if (mapped)
+        geo_vfs_unmap_file(rom, romsz);
+    else
+        free(rom);
+    geo_mixer_deinit();
+    geo_deinit();
+    geo_bios_unload();
+    free(vbuf);
+    free(abuf);
+
+    return failed ? 1 : 0;
+}
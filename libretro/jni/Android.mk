@@ -3,6 +3,7 @@ LOCAL_PATH := $(call my-dir)
 
 ROOT_DIR := $(LOCAL_PATH)/../..
 CORE_DIR := $(ROOT_DIR)
+HAVE_THREADS := 1
 
 include $(ROOT_DIR)/libretro/Makefile.common
 
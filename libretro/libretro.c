@@ -41,8 +41,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "geo_lspc.h"
 #include "geo_m68k.h"
 #include "geo_mixer.h"
+#include "geo_movie.h"
 #include "geo_neo.h"
 #include "geo_vfs.h"
+#include "geo_ymfm.h"
 #include "geo_z80.h"
 
 #include "libretro.h"
@@ -56,9 +58,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "streams/file_stream.h"
 
 #define SAMPLERATE_RESAMP 44100
-#define SAMPLERATE_ADJUSTED 44396 // Rate corrected for 60Hz vs ~59.19/59.60Hz
 #define SAMPLERATE_MVS 55555
 #define SAMPLERATE_AES 55943.49
+#define SIZE_ABUF 2048 // A frame of stereo samples, raw only at medium fidelity
+#define AUDIO_COST_FRAMES 300 // Frames per audio cost report
 
 #if defined(_WIN32)
    static const char pss = '\\';
@@ -73,6 +76,9 @@ static size_t numsamps = 0;
 
 // Copy of the ROM data passed in by the frontend
 static void *romdata = NULL;
+static size_t romsz = 0;
+static int rom_mmap = 0; // Map ROM and disc files rather than reading them
+static int rom_mapped = 0; // romdata is a file mapping rather than a buffer
 
 // ROM data verification
 static int verified = 0;
@@ -83,6 +89,22 @@ static int cd_systype = SYSTEM_CDZ;
 static int cd_speed_hack = 0;
 static int cd_dma_len_limit = 0;
 static int cd_skip_loading = 0;
+static unsigned cd_turbo_load = 1; // Data sector rate multiplier while skipping
+static int cd_preload = 0;
+static int cd_index_cache = 0;
+static int cd_preload_progress = -1; // Last reported disc preload percentage
+
+static int ym_fidelity = GEO_YMFM_FIDELITY_MED;
+static int audio_drc = 0; // Resample internally, following the frontend buffer
+static unsigned audio_lines = 0; // Scanlines per audio batch, 0 for per frame
+static int audio_direct = 0; // Pass audio to the frontend as soon as it is ready
+static int audio_cost = 0; // Log the cost of sound generation
+static unsigned audio_cost_frames = 0;
+static uint64_t audio_cost_samples = 0;
+static uint64_t audio_cost_blocks = 0;
+static int64_t audio_cost_usec = 0;
+static int64_t audio_cost_frame_usec = 0;
+static uint64_t audio_cost_idle[4] = { 0, 0, 0, 0 }; // FM, ADPCM-A/B, SSG
 
 // Game name without path or extension
 static char gamename[128];
@@ -128,6 +150,7 @@ static retro_audio_sample_batch_t audio_batch_cb = NULL;
 static retro_environment_t environ_cb = NULL;
 static retro_input_poll_t input_poll_cb = NULL;
 static retro_input_state_t input_state_cb = NULL;
+static retro_perf_get_time_usec_t get_time_usec_cb = NULL;
 
 // libretro input descriptors
 static struct retro_input_descriptor input_desc_js[] = { // Joysticks (Default)
@@ -617,8 +640,71 @@ static unsigned geo_input_poll_stat_b_irrmaze(void) {
     return s;
 }
 
+/* Cartridge audio is passed through raw at medium fidelity. It is resampled
+   internally when the rate is steered by the frontend buffer, and at high
+   fidelity, where the raw rate would be around 500kHz.
+*/
+static int audio_resamp_internal(void) {
+    return audio_drc || geo_ymfm_oversample() > 1;
+}
+
 static void geo_cb_audio(size_t samps) {
-    numsamps = samps >> 1;
+    if (audio_direct) {
+        audio_batch_cb(abuf, samps >> 1);
+        numsamps = 0;
+    }
+    else {
+        numsamps = samps >> 1;
+    }
+}
+
+// Set how often audio is passed to the frontend during emulation of a frame
+static void audio_interval_set(unsigned lines) {
+    geo_set_audio_lines(lines);
+    audio_direct = lines != 0;
+}
+
+static void geo_cb_audio_status(bool active, unsigned occupancy,
+    bool underrun_likely) {
+    (void)underrun_likely;
+    geo_mixer_set_fill(active ? (int)occupancy : -1);
+}
+
+// Accumulate sound generation costs and log the averages periodically
+static void audio_cost_report(void) {
+    geo_ymfm_stats_t stats;
+    geo_ymfm_get_stats(&stats);
+    audio_cost_samples += stats.samples;
+    audio_cost_blocks += stats.blocks;
+    audio_cost_usec += stats.usec;
+    audio_cost_idle[0] += stats.idle_fm;
+    audio_cost_idle[1] += stats.idle_adpcma;
+    audio_cost_idle[2] += stats.idle_adpcmb;
+    audio_cost_idle[3] += stats.idle_ssg;
+
+    if (++audio_cost_frames < AUDIO_COST_FRAMES)
+        return;
+
+    log_cb(RETRO_LOG_INFO, "[AUDIO] %.0f samples in %.1f blocks per frame, "
+        "%.3fms per frame (%.1f%% of emulation)\n",
+        (double)audio_cost_samples / audio_cost_frames,
+        (double)audio_cost_blocks / audio_cost_frames,
+        audio_cost_usec / 1000.0 / audio_cost_frames,
+        audio_cost_frame_usec > 0 ?
+            audio_cost_usec * 100.0 / audio_cost_frame_usec : 0.0);
+
+    if (audio_cost_samples) {
+        double pct = 100.0 / audio_cost_samples;
+        log_cb(RETRO_LOG_INFO, "[AUDIO] Idle engines skipped: FM %.1f%%, "
+            "ADPCM-A %.1f%%, ADPCM-B %.1f%%, SSG %.1f%% of samples\n",
+            audio_cost_idle[0] * pct, audio_cost_idle[1] * pct,
+            audio_cost_idle[2] * pct, audio_cost_idle[3] * pct);
+    }
+
+    audio_cost_frames = 0;
+    audio_cost_samples = audio_cost_blocks = 0;
+    audio_cost_usec = audio_cost_frame_usec = 0;
+    memset(audio_cost_idle, 0, sizeof(audio_cost_idle));
 }
 
 static void geo_geom_refresh(void) {
@@ -712,6 +798,30 @@ static void check_variables(bool first_run) {
                 systype = SYSTEM_UNI;
         }
 
+        // Preload Disc
+        var.key   = "geolith_cd_preload";
+        var.value = NULL;
+
+        if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+            cd_preload = !strcmp(var.value, "enabled");
+
+        // Cache Disc Track Index
+        var.key   = "geolith_cd_index_cache";
+        var.value = NULL;
+
+        if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+            cd_index_cache = !strcmp(var.value, "enabled");
+
+        // Memory Mapped File Access
+        var.key   = "geolith_rom_mmap";
+        var.value = NULL;
+
+        if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+            rom_mmap = !strcmp(var.value, "enabled");
+
+        // Mapping bypasses the frontend VFS, so only map when requested
+        geo_vfs_set_map(rom_mmap);
+
         // CD System Type
         var.key   = "geolith_cd_system_type";
         var.value = NULL;
@@ -778,6 +888,41 @@ static void check_variables(bool first_run) {
             else
                 settingmode = 0;
         }
+
+        // YM2610 Fidelity
+        var.key   = "geolith_ym_fidelity";
+        var.value = NULL;
+
+        if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value) {
+            ym_fidelity = !strcmp(var.value, "high") ?
+                GEO_YMFM_FIDELITY_MAX : GEO_YMFM_FIDELITY_MED;
+        }
+        geo_set_ym_fidelity(ym_fidelity);
+
+        // Audio Rate Control
+        var.key   = "geolith_audio_drc";
+        var.value = NULL;
+
+        if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+            audio_drc = !strcmp(var.value, "enabled");
+    }
+
+    // Audio Output Interval
+    var.key   = "geolith_audio_interval";
+    var.value = NULL;
+
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value) {
+        audio_lines = atoi(var.value); // "disabled" yields 0
+        audio_interval_set(audio_lines);
+    }
+
+    // Report Audio Cost
+    var.key   = "geolith_audio_cost";
+    var.value = NULL;
+
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value) {
+        audio_cost = get_time_usec_cb && !strcmp(var.value, "enabled");
+        geo_ymfm_set_clock(audio_cost ? get_time_usec_cb : NULL);
     }
 
     // CD Speed Hack
@@ -809,6 +954,15 @@ static void check_variables(bool first_run) {
         cd_skip_loading = !strcmp(var.value, "enabled");
     }
 
+    // Turbo CD Loading
+    var.key   = "geolith_cd_turbo_load";
+    var.value = NULL;
+
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value) {
+        int mult = atoi(var.value); // "disabled" yields 0
+        cd_turbo_load = mult > 1 ? mult : 1;
+    }
+
     // Memory Card Inserted
     var.key   = "geolith_memcard";
     var.value = NULL;
@@ -984,6 +1138,11 @@ void retro_init(void) {
     if (environ_cb(RETRO_ENVIRONMENT_GET_INPUT_BITMASKS, NULL))
         bitmasks = 1;
 
+    // Timer for loading instrumentation
+    struct retro_perf_callback perf;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_PERF_INTERFACE, &perf))
+        get_time_usec_cb = perf.get_time_usec;
+
     // Initialize VFS if the frontend supports it
     struct retro_vfs_interface_info vfs_iface_info;
     vfs_iface_info.required_interface_version = 1;
@@ -991,6 +1150,12 @@ void retro_init(void) {
     if (environ_cb(RETRO_ENVIRONMENT_GET_VFS_INTERFACE, &vfs_iface_info))
         filestream_vfs_init(&vfs_iface_info);
 
+    // Directory operations need a newer interface, otherwise stdio is used
+    vfs_iface_info.required_interface_version = PATH_REQUIRED_VFS_VERSION;
+    vfs_iface_info.iface = NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VFS_INTERFACE, &vfs_iface_info))
+        path_vfs_init(&vfs_iface_info);
+
     /* Hand the core our file I/O operations. filestream_* falls back to an
        internal stdio implementation when the frontend offers no VFS
        interface, so this is unconditional.
@@ -1017,7 +1182,7 @@ void retro_init(void) {
     geo_lspc_set_buffer(vbuf);
 
     // Allocate and pass the audio buffer into the emulator
-    abuf = (int16_t*)calloc(1, 2048 * sizeof(int16_t));
+    abuf = (int16_t*)calloc(1, SIZE_ABUF * sizeof(int16_t));
     geo_mixer_set_buffer(abuf);
 
     // Set up audio callback
@@ -1064,8 +1229,9 @@ void retro_get_system_av_info(struct retro_system_av_info *info) {
         info->timing = (struct retro_system_timing) {
             .fps = systype == SYSTEM_MVS || systype == SYSTEM_UNI ?
                 FRAMERATE_MVS : FRAMERATE_AES,
-            .sample_rate = systype == SYSTEM_MVS || systype == SYSTEM_UNI ?
-                SAMPLERATE_MVS : SAMPLERATE_AES
+            .sample_rate = audio_resamp_internal() ? SAMPLERATE_RESAMP :
+                (systype == SYSTEM_MVS || systype == SYSTEM_UNI ?
+                SAMPLERATE_MVS : SAMPLERATE_AES)
         };
     }
 
@@ -1091,9 +1257,10 @@ static void update_option_visibility(void) {
 
     // CD-only options: hide in cart mode
     const char *cd_opts[] = {
-        "geolith_cd_system_type", "geolith_cd_speed_hack",
+        "geolith_cd_system_type", "geolith_cd_preload",
+        "geolith_cd_index_cache", "geolith_cd_speed_hack",
         "geolith_cd_dma_len_limit", "geolith_cd_skip_loading",
-        NULL
+        "geolith_cd_turbo_load", NULL
     };
 
     for (int i = 0; cart_opts[i]; ++i) {
@@ -1145,7 +1312,7 @@ void retro_set_video_refresh(retro_video_refresh_t cb) {
 }
 
 void retro_reset(void) {
-    geo_reset(0);
+    geo_movie_reset(0);
 }
 
 void retro_run(void) {
@@ -1157,6 +1324,21 @@ void retro_run(void) {
         video_cb(vbuf + (LSPC_WIDTH * (video_crop_t + 16)) + video_crop_l,
             video_width_visible, video_height_visible, LSPC_WIDTH << 2);
         geo_lspc_set_skip_render(1);
+
+        /* Turbo loading raises the data sector rate and stops sound
+           generation, leaving the CPUs and the timers the BIOS waits on.
+        */
+        if (cd_turbo_load > 1) {
+            geo_cd_set_turbo(cd_turbo_load);
+            geo_ymfm_set_silent(1);
+        }
+
+        // Skipped frames produce no audio for the frontend
+        audio_interval_set(0);
+
+        uint64_t sectors = geo_cd_sectors_decoded();
+        retro_time_t start = get_time_usec_cb ? get_time_usec_cb() : 0;
+
         int skip = 0, idle = 0;
         while (idle < 20) {
             geo_cd_clear_sector_decoded();
@@ -1168,13 +1350,51 @@ void retro_run(void) {
                 ++idle;
         }
         geo_lspc_set_skip_render(0);
+        geo_cd_set_turbo(1);
+        geo_ymfm_set_silent(0);
         geo_cd_clear_sector_decoded();
-        log_cb(RETRO_LOG_INFO, "[CD SKIP] skipped %d frames\n", skip);
+        audio_interval_set(audio_lines);
+
+        sectors = geo_cd_sectors_decoded() - sectors;
+        if (get_time_usec_cb) {
+            double secs = (get_time_usec_cb() - start) / 1000000.0;
+            log_cb(RETRO_LOG_INFO, "[CD SKIP] skipped %d frames, %llu sectors "
+                "in %.2fs (%.0f sectors/s)\n", skip,
+                (unsigned long long)sectors, secs,
+                secs > 0.0 ? sectors / secs : 0.0);
+        }
+        else {
+            log_cb(RETRO_LOG_INFO, "[CD SKIP] skipped %d frames, %llu "
+                "sectors\n", skip, (unsigned long long)sectors);
+        }
     }
     geo_cd_clear_sector_decoded();
 
     // Display frame
-    geo_exec();
+    if (audio_cost) {
+        retro_time_t start = get_time_usec_cb();
+        geo_exec();
+        audio_cost_frame_usec += get_time_usec_cb() - start;
+        audio_cost_report();
+    }
+    else {
+        geo_exec();
+    }
+
+    // Report disc preload progress in 10% steps
+    if (cd_mode && cd_preload_progress < 100) {
+        int progress = geo_disc_preload_progress();
+        if (progress >= 0 && progress / 10 != cd_preload_progress / 10) {
+            struct retro_message_ext msg = {
+                "Preloading disc", 1000, 1, RETRO_LOG_INFO,
+                RETRO_MESSAGE_TARGET_OSD, RETRO_MESSAGE_TYPE_PROGRESS,
+                (int8_t)progress
+            };
+            environ_cb(RETRO_ENVIRONMENT_SET_MESSAGE_EXT, &msg);
+            log_cb(RETRO_LOG_DEBUG, "Disc preload: %d%%\n", progress);
+        }
+        cd_preload_progress = progress;
+    }
 
     bool update = false;
     if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE, &update) && update) {
@@ -1187,7 +1407,9 @@ void retro_run(void) {
         video_height_visible,
         LSPC_WIDTH << 2);
 
-    audio_batch_cb(abuf, numsamps);
+    if (numsamps)
+        audio_batch_cb(abuf, numsamps);
+    numsamps = 0;
 }
 
 bool retro_load_game(const struct retro_game_info *info) {
@@ -1217,7 +1439,7 @@ bool retro_load_game(const struct retro_game_info *info) {
             cd_mode = 1;
             systype = cd_systype;
             geo_mixer_deinit();
-            geo_mixer_set_rate(SAMPLERATE_ADJUSTED);
+            geo_mixer_set_rate(SAMPLERATE_RESAMP);
             geo_mixer_set_raw(0);
             geo_mixer_init();
             geo_cd_set_speed_hack(cd_systype == SYSTEM_CDU ? 0 : cd_speed_hack);
@@ -1229,6 +1451,23 @@ bool retro_load_game(const struct retro_game_info *info) {
     geo_set_system(systype);
     geo_init();
 
+    if (!cd_mode && audio_resamp_internal()) {
+        geo_mixer_set_rate(SAMPLERATE_RESAMP);
+        geo_mixer_init();
+        geo_mixer_set_raw(0);
+    }
+
+    if (audio_drc) {
+        struct retro_audio_buffer_status_callback buf_status = {
+            geo_cb_audio_status
+        };
+        if (!environ_cb(RETRO_ENVIRONMENT_SET_AUDIO_BUFFER_STATUS_CALLBACK,
+            &buf_status)) {
+            log_cb(RETRO_LOG_WARN, "Audio buffer status unavailable, audio "
+                "rate control disabled\n");
+        }
+    }
+
     update_option_visibility();
 
     char biospath[256];
@@ -1261,6 +1500,21 @@ bool retro_load_game(const struct retro_game_info *info) {
 
     if (cd_mode) {
         // CD mode: open disc image and byteswap BIOS
+        geo_disc_set_preload(cd_preload);
+        geo_disc_set_index_dir(NULL);
+        if (cd_index_cache &&
+            environ_cb(RETRO_ENVIRONMENT_GET_SAVE_DIRECTORY, &savedir) &&
+            savedir) {
+            // Track indices are kept apart from save data, in a core directory
+            char indexdir[292];
+            snprintf(indexdir, sizeof(indexdir), "%s%cgeolith", savedir, pss);
+            if (path_mkdir(indexdir))
+                geo_disc_set_index_dir(indexdir);
+            else
+                log_cb(RETRO_LOG_WARN, "Cannot create %s, disc track index "
+                    "caching disabled\n", indexdir);
+        }
+        cd_preload_progress = -1;
         if (!geo_disc_open(info->path)) {
             log_cb(RETRO_LOG_ERROR, "Failed to open disc: %s\n", info->path);
             retro_unload_game();
@@ -1272,7 +1526,25 @@ bool retro_load_game(const struct retro_game_info *info) {
         // Cartridge mode: load NEO file
         if (info->path) { // need_fullpath is true, so load from path
             size_t sz = 0;
-            romdata = geo_vfs_read_file(info->path, &sz);
+            romdata = NULL;
+            rom_mapped = 0;
+
+            /* Pages of the mapping which are never written (S, M, V, and C
+               ROM data) are shared with the page cache. Writes at load time,
+               such as byteswapping the P ROM or patching titles like
+               Matrimelee and Super Bubble Pop, are copied on write.
+            */
+            if (rom_mmap) {
+                romdata = geo_vfs_map_file(info->path, &sz);
+                rom_mapped = romdata != NULL;
+                if (!rom_mapped)
+                    log_cb(RETRO_LOG_WARN, "Unable to map ROM, reading\n");
+            }
+
+            if (!romdata)
+                romdata = geo_vfs_read_file(info->path, &sz);
+
+            romsz = sz;
             if (!romdata) {
                 log_cb(RETRO_LOG_ERROR, "Failed to read ROM: %s\n", info->path);
                 retro_unload_game();
@@ -1433,15 +1705,23 @@ void retro_unload_game(void) {
             log_cb(RETRO_LOG_DEBUG, "Save Failed: %s\n", savename);
     }
 
+    if (audio_drc)
+        environ_cb(RETRO_ENVIRONMENT_SET_AUDIO_BUFFER_STATUS_CALLBACK, NULL);
+
     if (cd_mode) {
         // CD mode: close disc and cleanup CD subsystem
         geo_disc_close();
         geo_cd_deinit();
     }
 
-    if (romdata)
+    if (rom_mapped)
+        geo_vfs_unmap_file(romdata, romsz);
+    else if (romdata)
         free(romdata);
 
+    romdata = NULL;
+    rom_mapped = 0;
+
     geo_bios_unload();
 
     verified = 0;
@@ -43,6 +43,11 @@ static struct retro_core_option_v2_category option_cats_us[] = {
       "Video",
       "Display and rendering settings"
    },
+   {
+      "audio",
+      "Audio",
+      "Sound generation settings"
+   },
    {
       "hacks",
       "Hacks",
@@ -88,6 +93,24 @@ static struct retro_core_option_v2_definition option_defs_us[] = {
       },
       "mvs"
    },
+   {
+      "geolith_rom_mmap",
+      "Memory Mapped File Access (Restart)",
+      "Memory Mapped File Access",
+      "Map NEO ROM files and BIN/WAV disc tracks into memory instead of "
+      "reading them through the frontend. ROM data which is never modified is "
+      "shared with the system's file cache and with other running instances, "
+      "and disc sectors are read without per-sector file I/O. Falls back to "
+      "normal reads when mapping is unavailable.",
+      NULL,
+      "system",
+      {
+         { "enabled", "Enabled" },
+         { "disabled", "Disabled" },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
    {
       "geolith_cd_system_type",
       "CD System Type (Restart)",
@@ -104,6 +127,37 @@ static struct retro_core_option_v2_definition option_defs_us[] = {
       },
       "cdz"
    },
+   {
+      "geolith_cd_preload",
+      "Preload Disc (Restart)",
+      "Preload Disc",
+      "Read the entire disc image into memory in the background after "
+      "loading, removing storage latency and CHD decompression from loading "
+      "screens. Requires enough free memory to hold the whole disc.",
+      NULL,
+      "system",
+      {
+         { "enabled", "Enabled" },
+         { "disabled", "Disabled" },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
+   {
+      "geolith_cd_index_cache",
+      "Cache Disc Track Index (Restart)",
+      "Cache Disc Track Index",
+      "Store the parsed track layout of CHD images in a 'geolith' folder in "
+      "the save directory so reopening an image skips reading its metadata.",
+      NULL,
+      "system",
+      {
+         { "enabled", "Enabled" },
+         { "disabled", "Disabled" },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
    {
       "geolith_region",
       "Region (Restart)",
@@ -288,6 +342,73 @@ static struct retro_core_option_v2_definition option_defs_us[] = {
       },
       "1:1"
    },
+   /* Audio */
+   {
+      "geolith_ym_fidelity",
+      "YM2610 Fidelity (Restart)",
+      "YM2610 Fidelity",
+      "Set the YM2610 output sample rate. High generates every SSG sample "
+      "at around 500kHz, nine times the work of Medium, and needs a much "
+      "faster CPU.",
+      NULL,
+      "audio",
+      {
+         { "medium", "Medium" },
+         { "high", "High" },
+         { NULL, NULL },
+      },
+      "medium"
+   },
+   {
+      "geolith_audio_drc",
+      "Audio Rate Control (Restart)",
+      NULL,
+      "Resample audio inside the core and adjust the rate slightly to keep "
+      "the frontend's audio buffer half full, allowing lower audio latency "
+      "settings without crackling. Requires frontend support for reporting "
+      "audio buffer occupancy. CD games are always resampled by the core.",
+      NULL,
+      "audio",
+      {
+         { "enabled", "Enabled" },
+         { "disabled", "Disabled" },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
+   {
+      "geolith_audio_interval",
+      "Audio Output Interval",
+      NULL,
+      "Pass audio to the frontend several times during each frame instead of "
+      "once at the end, so output of a frame's audio can begin before "
+      "emulation of the frame has finished.",
+      NULL,
+      "audio",
+      {
+         { "disabled", "Once per Frame" },
+         { "132", "Every 132 Lines (2 per Frame)" },
+         { "66", "Every 66 Lines (4 per Frame)" },
+         { "33", "Every 33 Lines (8 per Frame)" },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
+   {
+      "geolith_audio_cost",
+      "Report Audio Cost",
+      NULL,
+      "Periodically log how many YM2610 samples are generated per frame and "
+      "how much of the frame time is spent generating them.",
+      NULL,
+      "audio",
+      {
+         { "enabled", "Enabled" },
+         { "disabled", "Disabled" },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
    /* Hacks */
    {
       "geolith_sprlimit",
@@ -380,6 +501,24 @@ static struct retro_core_option_v2_definition option_defs_us[] = {
       },
       "disabled"
    },
+   {
+      "geolith_cd_turbo_load",
+      "Turbo CD Loading",
+      NULL,
+      "Read data sectors faster than the drive can, and skip sound "
+      "generation, while Skip CD Loading fast-forwards. Some games may fail "
+      "to load at higher speeds.",
+      NULL,
+      "hacks",
+      {
+         { "disabled", "Disabled" },
+         { "4x", "4x" },
+         { "8x", "8x" },
+         { "16x", "16x" },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
    { NULL, NULL, NULL, NULL, NULL, NULL, {{0}}, NULL },
 };
 
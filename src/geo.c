@@ -30,15 +30,18 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <miniz.h>
 
 #include "geo.h"
 #include "geo_cd.h"
+#include "geo_hash.h"
 #include "geo_lspc.h"
 #include "geo_m68k.h"
 #include "geo_memcard.h"
 #include "geo_mixer.h"
+#include "geo_movie.h"
 #include "geo_rtc.h"
 #include "geo_serial.h"
 #include "geo_vfs.h"
@@ -47,7 +50,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #define DIV_M68K 2
 #define DIV_Z80 6
-#define DIV_YM2610 72 // 72 for medium fidelity, 8 for high
+#define DIV_YM2610 72 // Z80 cycles per YM2610 sample at medium fidelity
 
 #define MCYC_PER_LINE 1536
 #define MCYC_PER_FRAME (MCYC_PER_LINE * 264) // 405504
@@ -71,13 +74,16 @@ static romdata_t romdata;
 
 static uint8_t *state = NULL;
 static size_t state_sz = 0;
-static uint32_t state_version = ('G' << 24) | ('E' << 16) | ('O' << 8) | 0x02;
+static uint32_t state_version = ('G' << 24) | ('E' << 16) | ('O' << 8) | 0x03;
 
 // Cycle counters
 static uint32_t mcycs = 0;
 static uint32_t zcycs = 0;
 static uint32_t ymcycs = 0;
+static uint32_t div_ym2610 = DIV_YM2610;
 static uint32_t ymsamps = 0;
+static uint32_t audio_mcycs = 0; // Audio output interval, 0 for once per frame
+static uint32_t audio_next = 0; // Master cycle count for the next audio output
 
 static unsigned icycs = 0;
 
@@ -140,6 +146,20 @@ void geo_set_adpcm_wrap(int w) {
     geo_ymfm_adpcm_wrap(w);
 }
 
+// Set the YM2610 output fidelity - must be called before geo_init
+void geo_set_ym_fidelity(int f) {
+    geo_ymfm_set_fidelity(f);
+    div_ym2610 = DIV_YM2610 / geo_ymfm_oversample();
+}
+
+/* Pass audio to the frontend every N scanlines rather than once per frame, so
+   output can start before the frame is complete. 0 restores once per frame.
+*/
+void geo_set_audio_lines(unsigned lines) {
+    audio_mcycs = lines < LSPC_SCANLINES ? lines * MCYC_PER_LINE : 0;
+    audio_next = audio_mcycs;
+}
+
 // Set a positive or negative tolerance adjustment to the watchdog counter
 void geo_set_watchdog_tolerance(int t) {
     watchdog_cycs += t;
@@ -482,6 +502,9 @@ void geo_reset(int hard) {
 
     if (hard)
         geo_m68k_interrupt(IRQ_RESET);
+
+    // Memory has been reinitialized outside of the usual write paths
+    geo_hash_invalidate();
 }
 
 void geo_init(void) {
@@ -527,9 +550,14 @@ void geo_init(void) {
     else {
         state = (uint8_t*)calloc(1, SIZE_STATE_CART);
     }
+
+    geo_hash_invalidate();
 }
 
 void geo_deinit(void) {
+    geo_movie_deinit();
+    geo_ymfm_deinit();
+
     if (state)
         free(state);
 }
@@ -572,7 +600,7 @@ int geo_state_load_raw(const void *sstate) {
     ngsys.sound_reply = geo_serial_pop8(st);
 
     geo_lspc_state_load(st);
-    geo_m68k_state_load(st);
+    geo_m68k_state_load(st, stver);
     geo_rtc_state_load(st);
     geo_ymfm_state_load(st, stver);
     geo_z80_state_load(st);
@@ -582,6 +610,8 @@ int geo_state_load_raw(const void *sstate) {
         geo_cd_state_load(st, stver);
     }
 
+    geo_hash_invalidate();
+
     return 1;
 }
 
@@ -746,6 +776,8 @@ void geo_watchdog_enable(unsigned enable) {
 }
 
 void geo_exec(void) {
+    geo_movie_frame_begin();
+
     while (mcycs < MCYC_PER_FRAME) {
         icycs = geo_m68k_run(1);
         mcycs += (icycs * DIV_M68K) >> oc;
@@ -797,20 +829,33 @@ void geo_exec(void) {
             size_t scycs = geo_z80_run(1);
             zcycs += scycs * DIV_Z80;
             ymcycs += scycs;
-            if (ymcycs >= DIV_YM2610) {
-                ymcycs -= DIV_YM2610;
+            while (ymcycs >= div_ym2610) { // Instructions may span samples
+                ymcycs -= div_ym2610;
                 ymsamps += geo_ymfm_exec();
             }
         }
+
+        // Pass audio generated so far to the frontend at each interval
+        if (audio_mcycs && mcycs >= audio_next) {
+            if (ymsamps)
+                geo_mixer_output(ymsamps);
+            ymsamps = 0;
+            audio_next += audio_mcycs;
+        }
     }
 
     mcycs %= MCYC_PER_FRAME;
     zcycs %= MCYC_PER_FRAME;
 
-    // Pass audio generated this frame to the frontend for output
-    geo_mixer_output(ymsamps);
+    // Pass the remaining audio generated this frame to the frontend
+    if (ymsamps)
+        geo_mixer_output(ymsamps);
     ymsamps = 0;
+    audio_next = audio_mcycs;
+    geo_mixer_frame_end();
 
     if (ngsys.cdmode)
         geo_cd_frame_end();
+
+    geo_movie_frame_end();
 }
@@ -207,6 +207,8 @@ int geo_get_system(void);
 void geo_set_system(int);
 void geo_set_div68k(int);
 void geo_set_adpcm_wrap(int);
+void geo_set_ym_fidelity(int);
+void geo_set_audio_lines(unsigned);
 void geo_set_watchdog_tolerance(int);
 
 uint32_t geo_calc_mask(unsigned, unsigned);
@@ -39,10 +39,12 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "geo.h"
 #include "geo_cd.h"
 #include "geo_disc.h"
+#include "geo_hash.h"
 #include "geo_lc8951.h"
 #include "geo_lspc.h"
 #include "geo_m68k.h"
 #include "geo_serial.h"
+#include "geo_ymfm.h"
 #include "geo_z80.h"
 
 // BIOS family detection
@@ -60,6 +62,37 @@ static uint8_t z80_ram_cd[SIZE_64K];   // Z80 RAM (replaces M1 ROM + banking)
 static uint8_t fix_ram[SIZE_128K];     // FIX layer RAM (replaces S ROM)
 static uint8_t bram[SIZE_8K];          // Backup RAM (replaces memory card)
 
+/* Sprite DRAM holds each line of tile data in the byte order [1, 0, 3, 2]
+   relative to the interleaved C ROM order [0, 2, 1, 3] the LSPC decodes.
+   A shadow copy in C ROM order is kept up to date by every write, so the
+   LSPC reads it exactly like cartridge C ROM. spr_dram stays authoritative
+   for CPU reads, states, and hashing.
+*/
+static uint8_t spr_shadow[SIZE_4M];
+static const uint8_t spr_shadow_pos[4] = { 2, 0, 3, 1 };
+
+static inline void spr_shadow_wr(uint32_t addr, uint8_t val) {
+    spr_shadow[(addr & ~3u) | spr_shadow_pos[addr & 3]] = val;
+}
+
+// Convert a range of Sprite DRAM into the shadow copy
+static void spr_shadow_sync(uint32_t addr, uint32_t len) {
+    uint32_t end = addr + len;
+
+    for (; (addr & 3) && addr < end; ++addr)
+        spr_shadow_wr(addr, spr_dram[addr]);
+
+    for (; addr + 4 <= end; addr += 4) {
+        spr_shadow[addr + 0] = spr_dram[addr + 1];
+        spr_shadow[addr + 1] = spr_dram[addr + 3];
+        spr_shadow[addr + 2] = spr_dram[addr + 0];
+        spr_shadow[addr + 3] = spr_dram[addr + 2];
+    }
+
+    for (; addr < end; ++addr)
+        spr_shadow_wr(addr, spr_dram[addr]);
+}
+
 // ROM data pointer
 static romdata_t *romdata = NULL;
 
@@ -241,37 +274,11 @@ static int dma_len_limit = 0;
 static int bios_family = CD_BIOS_UNKNOWN;
 static int sector_decoded_this_frame = 0;
 
-// Cached track lookup - avoids repeated forward scans through all tracks
-static unsigned cached_track = 1;
-static uint32_t cached_track_start = 0;
-static uint32_t cached_track_end = 0;
-
-// Find which 1-based track a disc LBA belongs to.
-// Uses backward search (first match wins) and caches the result.
-static unsigned find_track_for_lba(uint32_t lba) {
-    // Fast path: check cached track
-    if (lba >= cached_track_start && lba < cached_track_end)
-        return cached_track;
-
-    unsigned ntracks = geo_disc_num_tracks();
-    unsigned track = 1;
-    for (unsigned i = ntracks; i > 0; --i) {
-        if (lba >= geo_disc_track_start(i)) {
-            track = i;
-            break;
-        }
-    }
-
-    // Update cache
-    cached_track = track;
-    cached_track_start = geo_disc_track_start(track);
-    if (track < ntracks)
-        cached_track_end = geo_disc_track_start(track + 1);
-    else
-        cached_track_end = geo_disc_leadout();
-
-    return track;
-}
+/* Turbo loading divides the data sector period while the frontend fast
+   forwards through a load. Audio tracks always play at their normal rate.
+*/
+static unsigned turbo = 1;
+static uint64_t sectors_decoded = 0; // Total data sectors fed to the LC8951
 
 /* CDDA audio - demand-driven by the mixer (not timed according to the master
    clock based tick function). The mixer calls geo_cd_read_cdda() to pull
@@ -387,7 +394,7 @@ static void cd_comm_process_command(void) {
                     cd.status[1] = to_bcd(m);
                     cd.status[2] = to_bcd(s);
                     cd.status[3] = to_bcd(f);
-                    unsigned trk = find_track_for_lba(cd.play_lba);
+                    unsigned trk = geo_disc_find_track(cd.play_lba);
                     cd.status[4] = !geo_disc_track_is_audio(trk) ? 0x40 : 0x00;
                     break;
                 }
@@ -397,12 +404,12 @@ static void cd_comm_process_command(void) {
                     cd.status[1] = to_bcd(m);
                     cd.status[2] = to_bcd(s);
                     cd.status[3] = to_bcd(f);
-                    unsigned trk = find_track_for_lba(cd.play_lba);
+                    unsigned trk = geo_disc_find_track(cd.play_lba);
                     cd.status[4] = !geo_disc_track_is_audio(trk) ? 0x40 : 0x00;
                     break;
                 }
                 case 0x02: { // Current track
-                    unsigned track = find_track_for_lba(cd.play_lba);
+                    unsigned track = geo_disc_find_track(cd.play_lba);
                     int is_data = !geo_disc_track_is_audio(track);
                     cd.status[0] = cd.drive_status | 0x02;
                     cd.status[1] = to_bcd(track);
@@ -467,7 +474,7 @@ static void cd_comm_process_command(void) {
                     cd.status[1] = 0;
                     cd.status[2] = 0;
                     cd.status[3] = 0;
-                    unsigned trk = find_track_for_lba(cd.play_lba);
+                    unsigned trk = geo_disc_find_track(cd.play_lba);
                     cd.status[4] = !geo_disc_track_is_audio(trk) ? 0x40 : 0x00;
                     break;
                 }
@@ -500,7 +507,7 @@ static void cd_comm_process_command(void) {
             cd.play_lba = lba;
             cd.target_lba = lba;
 
-            unsigned track = find_track_for_lba(lba);
+            unsigned track = geo_disc_find_track(lba);
 
             if (geo_disc_track_is_audio(track)) {
                 cd.playing_audio = 1;
@@ -710,13 +717,29 @@ static void dma_write_word(uint8_t *ptr, uint32_t mask, uint32_t *offset,
                     uint32_t addr = *offset & (mask & ~1u);
                     ptr[addr] = (data >> 8) & 0xff;
                     ptr[addr + 1] = data & 0xff;
+                    spr_shadow_wr((spr_bank * SIZE_1M) + addr, data >> 8);
+                    spr_shadow_wr((spr_bank * SIZE_1M) + addr + 1, data);
+                    geo_hash_dirty(GEO_HASH_AREA_SPRDRAM,
+                        (spr_bank * SIZE_1M) + addr);
+                    break;
+                }
+                case TRANSAREA_PCM: { // PCM - address >> 1, low byte
+                    uint32_t addr = (*offset >> 1) & mask;
+                    ptr[addr] = data & 0xff;
+                    geo_hash_dirty(GEO_HASH_AREA_PCMDRAM,
+                        (pcm_bank * SIZE_512K) + addr);
+                    break;
+                }
+                case TRANSAREA_Z80: { // Z80 - address >> 1, low byte
+                    uint32_t addr = (*offset >> 1) & mask;
+                    ptr[addr] = data & 0xff;
+                    geo_hash_dirty(GEO_HASH_AREA_Z80RAM, addr);
                     break;
                 }
-                case TRANSAREA_PCM: // PCM - address >> 1, low byte
-                case TRANSAREA_Z80: // Z80 - address >> 1, low byte
                 case TRANSAREA_FIX: { // FIX - address >> 1, low byte
                     uint32_t addr = (*offset >> 1) & mask;
                     ptr[addr] = data & 0xff;
+                    geo_hash_dirty(GEO_HASH_AREA_FIXRAM, addr);
                     break;
                 }
             }
@@ -731,12 +754,155 @@ static void dma_write_word(uint8_t *ptr, uint32_t mask, uint32_t *offset,
             // Program RAM - big-endian word write
             ptr[*offset & mask] = (data >> 8) & 0xff;
             ptr[(*offset + 1) & mask] = data & 0xff;
+            geo_hash_dirty_range(GEO_HASH_AREA_MAINRAM, *offset & mask, 2);
             break;
         }
     }
     *offset += 2;
 }
 
+/* Bulk DMA kernels
+   Resolving the destination per word is wasteful for transfers which move
+   real data - sprite uploads during loading run to megabytes. These kernels
+   take a run of words and resolve the destination once, falling back to
+   dma_write_word only when the run wraps around the destination window.
+*/
+#define DMA_BLOCK_WORDS 1024
+
+// Mark a run of bytes within a wrapping window dirty for state hashing
+static void dma_dirty(unsigned area, uint32_t base, uint32_t size,
+                      uint32_t off, uint32_t len) {
+    if (off + len <= size) {
+        geo_hash_dirty_range(area, base + off, len);
+    }
+    else {
+        geo_hash_dirty_range(area, base + off, size - off);
+        geo_hash_dirty_range(area, base, len - (size - off));
+    }
+}
+
+static void dma_write_block(uint8_t *ptr, uint32_t mask, uint32_t *offset,
+                            const uint16_t *data, uint32_t n, int dest_type) {
+    uint32_t off = *offset;
+
+    switch (dest_type) {
+        case DMA_DEST_MAPPED: {
+            if (reg_transarea == TRANSAREA_SPR) {
+                // Big-endian words, byte addressed
+                uint32_t addr = off & mask;
+                if ((off & 1) || addr + (n << 1) > mask + 1)
+                    break;
+
+                uint8_t *d = ptr + addr;
+                for (uint32_t i = 0; i < n; ++i) {
+                    d[i << 1] = data[i] >> 8;
+                    d[(i << 1) + 1] = data[i];
+                }
+                spr_shadow_sync((spr_bank * SIZE_1M) + addr, n << 1);
+                geo_hash_dirty_range(GEO_HASH_AREA_SPRDRAM,
+                    (spr_bank * SIZE_1M) + addr, n << 1);
+            }
+            else {
+                // Low byte of each word, word addressed
+                uint32_t addr = (off >> 1) & mask;
+                if (addr + n > mask + 1)
+                    break;
+
+                uint8_t *d = ptr + addr;
+                for (uint32_t i = 0; i < n; ++i)
+                    d[i] = data[i];
+
+                switch (reg_transarea) {
+                    case TRANSAREA_PCM:
+                        geo_hash_dirty_range(GEO_HASH_AREA_PCMDRAM,
+                            (pcm_bank * SIZE_512K) + addr, n);
+                        break;
+                    case TRANSAREA_Z80:
+                        geo_hash_dirty_range(GEO_HASH_AREA_Z80RAM, addr, n);
+                        break;
+                    case TRANSAREA_FIX:
+                        geo_hash_dirty_range(GEO_HASH_AREA_FIXRAM, addr, n);
+                        break;
+                }
+            }
+            *offset = off + (n << 1);
+            return;
+        }
+        case DMA_DEST_PALETTE: {
+            geo_lspc_palram_wr_block(off, data, n);
+            *offset = off + (n << 1);
+            return;
+        }
+        default: {
+            uint32_t addr = off & mask;
+            if ((off & 1) || addr + (n << 1) > mask + 1)
+                break;
+
+            uint8_t *d = ptr + addr;
+            for (uint32_t i = 0; i < n; ++i) {
+                d[i << 1] = data[i] >> 8;
+                d[(i << 1) + 1] = data[i];
+            }
+            geo_hash_dirty_range(GEO_HASH_AREA_MAINRAM, addr, n << 1);
+            *offset = off + (n << 1);
+            return;
+        }
+    }
+
+    // The run wraps or is misaligned, so take the word path
+    for (uint32_t i = 0; i < n; ++i)
+        dma_write_word(ptr, mask, offset, data[i], dest_type);
+}
+
+/* Copy sector data from the LC8951 buffer straight into Program RAM or
+   Sprite DRAM. Both hold big-endian words in byte order, exactly like the
+   buffer, so this is a memcpy split wherever either side wraps. Returns 0 if
+   the destination does not qualify.
+*/
+static int dma_copy_lc8951(uint8_t *ptr, uint32_t mask, uint32_t dst,
+                           uint16_t dac, uint32_t len, int dest_type) {
+    unsigned area;
+    uint32_t base;
+
+    if (dest_type == DMA_DEST_RAM) {
+        area = GEO_HASH_AREA_MAINRAM;
+        base = 0;
+    }
+    else if (dest_type == DMA_DEST_MAPPED && reg_transarea == TRANSAREA_SPR) {
+        area = GEO_HASH_AREA_SPRDRAM;
+        base = spr_bank * SIZE_1M;
+    }
+    else {
+        return 0;
+    }
+
+    if (dst & 1)
+        return 0;
+
+    uint32_t size = mask + 1;
+    uint32_t off = dst & mask;
+    uint32_t remain = len << 1;
+
+    dma_dirty(area, base, size, off, remain);
+
+    while (remain) {
+        uint32_t chunk = remain;
+        if (chunk > LC8951_BUFSZ - dac)
+            chunk = LC8951_BUFSZ - dac;
+        if (chunk > size - off)
+            chunk = size - off;
+
+        memcpy(ptr + off, &lc.buffer[dac], chunk);
+        if (area == GEO_HASH_AREA_SPRDRAM)
+            spr_shadow_sync(base + off, chunk);
+        dac = (uint16_t)(dac + chunk);
+        off = (off + chunk) & mask;
+        remain -= chunk;
+    }
+
+    return 1;
+}
+
 /* CD buffer DMA length limit
    The BIOS programs descriptors far larger than one sector when filling PCM
    DRAM - Art of Fighting asks for 0x20000 words entering the bonus stage. The
@@ -782,6 +948,7 @@ static void cd_dma_limit_len(uint32_t *len) {
 
     write16(pram, BIOS_VAR_UPLOAD_LEN, 0x0000);
     write16(pram, BIOS_VAR_UPLOAD_LEN + 2, DMA_CDBUF_MAX_WORDS * 2);
+    geo_hash_dirty_range(GEO_HASH_AREA_MAINRAM, BIOS_VAR_UPLOAD_LEN, 4);
     *len = DMA_CDBUF_MAX_WORDS;
 }
 
@@ -800,6 +967,10 @@ static void cd_dma_execute(void) {
         return;
     }
 
+    // Samples so far must be generated from the old PCM DRAM contents
+    if (dest_type == DMA_DEST_MAPPED && reg_transarea == TRANSAREA_PCM)
+        geo_ymfm_pcm_dirty();
+
     /* DMA Microcode Execution
        The LC8953 DMA controller uses a programmable microcode architecture.
        The 16-bit config word (REG_DMA_MODE) determines the transfer mode.
@@ -832,11 +1003,21 @@ static void cd_dma_execute(void) {
             if (lc_words > 0 && len > lc_words)
                 len = lc_words;
             uint16_t dac = lc.dacl;
-            for (uint32_t i = 0; i < len; ++i) {
-                uint16_t data = ((uint16_t)lc.buffer[dac] << 8) |
-                    lc.buffer[(uint16_t)(dac + 1)];
-                dma_write_word(dst_ptr, dst_mask, &dst, data, dest_type);
-                dac += 2;
+            if (dma_copy_lc8951(dst_ptr, dst_mask, dst, dac, len, dest_type)) {
+                geo_lc8951_end_transfer(&lc);
+                break;
+            }
+
+            uint16_t block[DMA_BLOCK_WORDS];
+            while (len) {
+                uint32_t n = len < DMA_BLOCK_WORDS ? len : DMA_BLOCK_WORDS;
+                for (uint32_t i = 0; i < n; ++i) {
+                    block[i] = ((uint16_t)lc.buffer[dac] << 8) |
+                        lc.buffer[(uint16_t)(dac + 1)];
+                    dac += 2;
+                }
+                dma_write_block(dst_ptr, dst_mask, &dst, block, n, dest_type);
+                len -= n;
             }
             geo_lc8951_end_transfer(&lc);
             break;
@@ -858,13 +1039,21 @@ static void cd_dma_execute(void) {
             uint32_t lc_words = (lc.dbc + 1) / 2;
             if (lc_words > 0 && len > lc_words)
                 len = lc_words;
+            // Each source byte becomes one destination word
             uint16_t dac = lc.dacl;
-            for (uint32_t i = 0; i < len; ++i) {
-                uint16_t data = ((uint16_t)lc.buffer[dac] << 8) |
-                    lc.buffer[(uint16_t)(dac + 1)];
-                dma_write_word(dst_ptr, dst_mask, &dst, data >> 8, dest_type);
-                dma_write_word(dst_ptr, dst_mask, &dst, data, dest_type);
-                dac += 2;
+            uint16_t block[DMA_BLOCK_WORDS];
+            while (len) {
+                uint32_t n = len < (DMA_BLOCK_WORDS >> 1) ?
+                    len : (DMA_BLOCK_WORDS >> 1);
+                for (uint32_t i = 0; i < n; ++i) {
+                    block[i << 1] = lc.buffer[dac];
+                    block[(i << 1) + 1] = ((uint16_t)lc.buffer[dac] << 8) |
+                        lc.buffer[(uint16_t)(dac + 1)];
+                    dac += 2;
+                }
+                dma_write_block(dst_ptr, dst_mask, &dst, block, n << 1,
+                    dest_type);
+                len -= n;
             }
             geo_lc8951_end_transfer(&lc);
             break;
@@ -895,10 +1084,15 @@ static void cd_dma_execute(void) {
                     break;
             }
 
-            for (uint32_t i = 0; i < dma.len; ++i) {
-                uint16_t w = read16(pram, src & (SIZE_2M - 1));
-                dma_write_word(dst_ptr, dst_mask, &dst, w, dest_type);
-                src += 2;
+            uint16_t block[DMA_BLOCK_WORDS];
+            for (uint32_t len = dma.len; len; ) {
+                uint32_t n = len < DMA_BLOCK_WORDS ? len : DMA_BLOCK_WORDS;
+                for (uint32_t i = 0; i < n; ++i) {
+                    block[i] = read16(pram, src & (SIZE_2M - 1));
+                    src += 2;
+                }
+                dma_write_block(dst_ptr, dst_mask, &dst, block, n, dest_type);
+                len -= n;
             }
             break;
         }
@@ -922,8 +1116,14 @@ static void cd_dma_execute(void) {
                handler.
             */
             uint32_t dst = dma.dst;
-            for (uint32_t i = 0; i < dma.len; ++i) {
-                dma_write_word(dst_ptr, dst_mask, &dst, dma.val, dest_type);
+            uint16_t block[DMA_BLOCK_WORDS];
+            for (uint32_t i = 0; i < DMA_BLOCK_WORDS; ++i)
+                block[i] = dma.val;
+
+            for (uint32_t len = dma.len; len; ) {
+                uint32_t n = len < DMA_BLOCK_WORDS ? len : DMA_BLOCK_WORDS;
+                dma_write_block(dst_ptr, dst_mask, &dst, block, n, dest_type);
+                len -= n;
             }
             break;
         }
@@ -944,12 +1144,19 @@ static void cd_dma_execute(void) {
                 break;
             }
 
-            for (uint32_t i = 0; i < dma.len; ++i) {
-                uint16_t data = read16(pram, src & (SIZE_2M - 1));
-                uint16_t swapped = (data >> 8) | (data << 8);
-                dma_write_word(dst_ptr, dst_mask, &dst, swapped, dest_type);
-                dma_write_word(dst_ptr, dst_mask, &dst, data, dest_type);
-                src += 2;
+            uint16_t block[DMA_BLOCK_WORDS];
+            for (uint32_t len = dma.len; len; ) {
+                uint32_t n = len < (DMA_BLOCK_WORDS >> 1) ?
+                    len : (DMA_BLOCK_WORDS >> 1);
+                for (uint32_t i = 0; i < n; ++i) {
+                    uint16_t data = read16(pram, src & (SIZE_2M - 1));
+                    block[i << 1] = (data >> 8) | (data << 8);
+                    block[(i << 1) + 1] = data;
+                    src += 2;
+                }
+                dma_write_block(dst_ptr, dst_mask, &dst, block, n << 1,
+                    dest_type);
+                len -= n;
             }
             break;
         }
@@ -1367,22 +1574,35 @@ static void transfer_write_8(uint32_t addr, uint8_t val) {
             if (!busreq_spr)
                 return;
             spr_dram[(spr_bank * SIZE_1M) + (addr & (SIZE_1M - 1))] = val;
+            spr_shadow_wr((spr_bank * SIZE_1M) + (addr & (SIZE_1M - 1)), val);
+            geo_hash_dirty(GEO_HASH_AREA_SPRDRAM,
+                (spr_bank * SIZE_1M) + (addr & (SIZE_1M - 1)));
             return;
         }
         case TRANSAREA_PCM: { // PCM - Odd bytes only
-            if (busreq_pcm && (addr & 1))
-                pcm_dram[(pcm_bank * SIZE_512K) +
-                    ((addr >> 1) & (SIZE_512K - 1))] = val;
+            if (busreq_pcm && (addr & 1)) {
+                geo_ymfm_pcm_dirty(); // Samples so far were read from old data
+                uint32_t pcm_addr = (pcm_bank * SIZE_512K) +
+                    ((addr >> 1) & (SIZE_512K - 1));
+                pcm_dram[pcm_addr] = val;
+                geo_hash_dirty(GEO_HASH_AREA_PCMDRAM, pcm_addr);
+            }
             return;
         }
         case TRANSAREA_Z80: { // Z80 - Odd bytes only
-            if (busreq_z80 && (addr & 1))
+            if (busreq_z80 && (addr & 1)) {
                 z80_ram_cd[(addr >> 1) & (SIZE_64K - 1)] = val;
+                geo_hash_dirty(GEO_HASH_AREA_Z80RAM,
+                    (addr >> 1) & (SIZE_64K - 1));
+            }
             return;
         }
         case TRANSAREA_FIX: { // FIX - Odd bytes only
-            if (busreq_fix && (addr & 1))
+            if (busreq_fix && (addr & 1)) {
                 fix_ram[(addr >> 1) & (SIZE_128K - 1)] = val;
+                geo_hash_dirty(GEO_HASH_AREA_FIXRAM,
+                    (addr >> 1) & (SIZE_128K - 1));
+            }
             return;
         }
     }
@@ -1398,14 +1618,19 @@ static void transfer_write_16(uint32_t addr, uint16_t val) {
             uint32_t spr_addr = (spr_bank * SIZE_1M) + (addr & (SIZE_1M - 2));
             spr_dram[spr_addr] = val >> 8;
             spr_dram[spr_addr + 1] = val & 0xff;
+            spr_shadow_wr(spr_addr, val >> 8);
+            spr_shadow_wr(spr_addr + 1, val);
+            geo_hash_dirty(GEO_HASH_AREA_SPRDRAM, spr_addr);
             return;
         }
         case TRANSAREA_PCM: { // PCM
             if (!busreq_pcm)
                 return;
+            geo_ymfm_pcm_dirty(); // Samples so far were read from old data
             uint32_t pcm_addr = (pcm_bank * SIZE_512K) +
                 ((addr >> 1) & (SIZE_512K - 1));
             pcm_dram[pcm_addr] = val & 0xff;
+            geo_hash_dirty(GEO_HASH_AREA_PCMDRAM, pcm_addr);
             return;
         }
         case TRANSAREA_Z80: { // Z80
@@ -1413,6 +1638,7 @@ static void transfer_write_16(uint32_t addr, uint16_t val) {
                 return;
             uint32_t z_addr = (addr >> 1) & (SIZE_64K - 1);
             z80_ram_cd[z_addr] = val & 0xff;
+            geo_hash_dirty(GEO_HASH_AREA_Z80RAM, z_addr);
             return;
         }
         case TRANSAREA_FIX: { // FIX
@@ -1420,6 +1646,7 @@ static void transfer_write_16(uint32_t addr, uint16_t val) {
                 return;
             uint32_t fix_addr = (addr >> 1) & (SIZE_128K - 1);
             fix_ram[fix_addr] = val & 0xff;
+            geo_hash_dirty(GEO_HASH_AREA_FIXRAM, fix_addr);
             return;
         }
     }
@@ -1584,6 +1811,7 @@ void geo_cd_m68k_write_8(unsigned address, unsigned value) {
 
     if (address < 0x200000) { // Program RAM
         pram[address] = value;
+        geo_hash_dirty(GEO_HASH_AREA_MAINRAM, address);
     }
     else if (address < 0x300000) { // Unused
         return;
@@ -1652,6 +1880,7 @@ void geo_cd_m68k_write_8(unsigned address, unsigned value) {
     }
     else if (address < 0xc00000) { // Backup RAM
         bram[(address >> 1) & 0x1fff] = value;
+        geo_hash_dirty(GEO_HASH_AREA_BRAM, (address >> 1) & 0x1fff);
     }
     else if (address < 0xd00000) { // BIOS ROM (read-only)
         return;
@@ -1673,6 +1902,7 @@ void geo_cd_m68k_write_16(unsigned address, unsigned value) {
 
     if (address < 0x200000) {
         write16(pram, address, value);
+        geo_hash_dirty(GEO_HASH_AREA_MAINRAM, address);
     }
     else if (address < 0x300000) {
         return;
@@ -1726,6 +1956,7 @@ void geo_cd_m68k_write_16(unsigned address, unsigned value) {
     }
     else if (address < 0xc00000) {
         bram[(address >> 1) & 0x1fff] = value & 0xff;
+        geo_hash_dirty(GEO_HASH_AREA_BRAM, (address >> 1) & 0x1fff);
     }
     else if (address < 0xd00000) {
         return;
@@ -1770,6 +2001,9 @@ void geo_cd_tick(unsigned mcycles) {
             cd_sector_rate = CD_SECTOR_RATE_2X;
         else
             cd_sector_rate = CD_SECTOR_RATE_1X;
+
+        if (cd.playing_data)
+            cd_sector_rate /= turbo;
     }
     else {
         cd_sector_rate = CD_SECTOR_RATE_IDLE;
@@ -1783,7 +2017,7 @@ void geo_cd_tick(unsigned mcycles) {
         if (cd.drive_status == CD_STATUS_PLAY &&
             (cd.playing_data || cd.playing_audio)) {
             // Determine audio vs data from current LBA's track type
-            unsigned cur_track = find_track_for_lba(cd.play_lba);
+            unsigned cur_track = geo_disc_find_track(cd.play_lba);
             int is_audio = geo_disc_track_is_audio(cur_track);
 
             cd.playing_audio = is_audio;
@@ -1791,8 +2025,10 @@ void geo_cd_tick(unsigned mcycles) {
             cdda_playing = is_audio;
 
             // Only run the LC8951 sector decoder for data tracks
-            if (cd.playing_data)
+            if (cd.playing_data) {
                 geo_lc8951_sector_decoded(&lc, cd.play_lba);
+                ++sectors_decoded;
+            }
 
             if (lc.decoder_enabled &&
                 (irq_mask1 & 0x500) == 0x500 &&
@@ -1836,18 +2072,19 @@ void geo_cd_set_vbl_pending(void) {
    are handled by the NEO-MGA.
 */
 
-// Read new audio data from CD as needed, silence when not playing
-void geo_cd_read_cdda(int16_t *out, size_t numsamps) {
-    for (size_t i = 0; i < numsamps; ++i) {
-        if (!cdda_playing) { // Silence!
-            out[i << 1] = out[(i << 1) + 1] = 0;
-            continue;
-        }
+/* Read new audio data from CD as needed, a whole sector at a time, copying
+   out runs of samples up to each sector boundary. Returns 0 without touching
+   the output when nothing is playing, so the caller can skip mixing silence.
+*/
+int geo_cd_read_cdda(int16_t *out, size_t numsamps) {
+    if (!cdda_playing)
+        return 0;
 
+    while (numsamps) {
         // Check if a new sector should be read
         if (cdda_sector_pos >= CDDA_SAMPS_PER_SECTOR) {
             if (cdda_audio_lba < geo_disc_leadout() &&
-                geo_disc_track_is_audio(find_track_for_lba(cdda_audio_lba))) {
+                geo_disc_track_is_audio(geo_disc_find_track(cdda_audio_lba))) {
                 if (!geo_disc_read_audio(cdda_audio_lba, cdda_sector_cache))
                     memset(cdda_sector_cache, 0, sizeof(cdda_sector_cache));
             }
@@ -1858,10 +2095,18 @@ void geo_cd_read_cdda(int16_t *out, size_t numsamps) {
             cdda_sector_pos = 0;
         }
 
-        out[i << 1]     = cdda_sector_cache[cdda_sector_pos << 1];
-        out[(i << 1) + 1] = cdda_sector_cache[(cdda_sector_pos << 1) + 1];
-        ++cdda_sector_pos;
+        size_t n = CDDA_SAMPS_PER_SECTOR - cdda_sector_pos;
+        if (n > numsamps)
+            n = numsamps;
+
+        memcpy(out, &cdda_sector_cache[cdda_sector_pos << 1],
+            n * 2 * sizeof(int16_t));
+        out += n << 1;
+        cdda_sector_pos += n;
+        numsamps -= n;
     }
+
+    return 1;
 }
 
 void geo_cd_frame_end(void) {
@@ -1956,6 +2201,16 @@ void geo_cd_clear_sector_decoded(void) {
     sector_decoded_this_frame = 0;
 }
 
+// Set the data sector rate multiplier, 1 for normal speed
+void geo_cd_set_turbo(unsigned mult) {
+    turbo = mult ? mult : 1;
+}
+
+// Total number of data sectors decoded since power on
+uint64_t geo_cd_sectors_decoded(void) {
+    return sectors_decoded;
+}
+
 void geo_cd_postload(void) {
     // First, byteswap the BIOS
     geo_m68k_bios_bswap();
@@ -1985,6 +2240,7 @@ void geo_cd_init(void) {
 
     memset(pram, 0, SIZE_2M);
     memset(spr_dram, 0, SIZE_4M);
+    memset(spr_shadow, 0, SIZE_4M);
     memset(pcm_dram, 0, SIZE_1M);
     memset(z80_ram_cd, 0, SIZE_64K);
     memset(fix_ram, 0, SIZE_128K);
@@ -2008,7 +2264,7 @@ void geo_cd_init(void) {
     memset(&dma, 0, sizeof(dma));
 
     // Redirect ROM data pointers to CD RAM for LSPC and YM2610
-    romdata->c = spr_dram;
+    romdata->c = spr_shadow;
     romdata->csz = SIZE_4M;
     romdata->s = fix_ram;
     romdata->ssz = SIZE_128K;
@@ -2024,6 +2280,9 @@ void geo_cd_init(void) {
     // Recalculate LSPC masks for the new ROM sizes, assign FIX data pointer
     geo_lspc_postload();
     geo_lspc_set_fix(LSPC_FIX_CD);
+
+    // Point the ADPCM engines at PCM DRAM
+    geo_ymfm_postload();
 }
 
 void geo_cd_deinit(void) {
@@ -2055,10 +2314,6 @@ void geo_cd_reset(void) {
     cdda_sector_pos = CDDA_SAMPS_PER_SECTOR;
     memset(cdda_sector_cache, 0, sizeof(cdda_sector_cache));
     cd_frame_mcycs = 0;
-    cached_track = 1;
-    cached_track_start = 0;
-    cached_track_end = 0;
-
     geo_lc8951_reset(&lc);
     cd_comm_reset();
     memset(&dma, 0, sizeof(dma));
@@ -2080,6 +2335,10 @@ const void* geo_cd_pram_ptr(void) {
     return pram;
 }
 
+const void* geo_cd_sprdram_ptr(void) {
+    return spr_dram;
+}
+
 static void cdcomm_state_save(uint8_t *st) {
     for (size_t i = 0; i < 5; ++i) geo_serial_push8(st, cd.cmd[i]);
     for (size_t i = 0; i < 5; ++i) geo_serial_push8(st, cd.status[i]);
@@ -2177,6 +2436,7 @@ void geo_cd_state_save(uint8_t *st) {
 void geo_cd_state_load(uint8_t *st, unsigned ver) {
     geo_serial_popblk(pram, st, SIZE_2M);
     geo_serial_popblk(spr_dram, st, SIZE_4M);
+    spr_shadow_sync(0, SIZE_4M);
     geo_serial_popblk(pcm_dram, st, SIZE_1M);
     geo_serial_popblk(z80_ram_cd, st, SIZE_64K);
     geo_serial_popblk(fix_ram, st, SIZE_128K);
@@ -2227,13 +2487,6 @@ void geo_cd_state_load(uint8_t *st, unsigned ver) {
     cdda_audio_lba = geo_serial_pop32(st);
     cdda_playing = geo_serial_pop8(st);
 
-    // Rebuild track cache from current position
-    cached_track = 1;
-    cached_track_start = 0;
-    cached_track_end = 0;
-    if (geo_disc_num_tracks() > 0)
-        find_track_for_lba(cd.play_lba);
-
     // Restore LSPC rendering state
     geo_lspc_disblspr_wr(reg_disblspr);
     geo_lspc_disblfix_wr(reg_disblfix);
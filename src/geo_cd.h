@@ -54,7 +54,7 @@ int geo_cd_vbl_enabled(void);
 void geo_cd_set_vbl_pending(void);
 
 // CDDA audio access for mixer
-void geo_cd_read_cdda(int16_t *out, size_t nsamples);
+int geo_cd_read_cdda(int16_t *out, size_t nsamples);
 void geo_cd_frame_start(void);
 
 // State serialization
@@ -64,6 +64,7 @@ void geo_cd_state_save(uint8_t *st);
 // RAM access for save data and memory maps
 const void* geo_cd_bram_ptr(void);
 const void* geo_cd_pram_ptr(void);
+const void* geo_cd_sprdram_ptr(void);
 
 int geo_cd_detect_bios(uint8_t *bios, size_t sz);
 void geo_cd_set_speed_hack(int enabled);
@@ -73,4 +74,8 @@ void geo_cd_set_dma_len_limit(int enabled);
 int geo_cd_sector_decoded_this_frame(void);
 void geo_cd_clear_sector_decoded(void);
 
+// Turbo loading - data sector rate multiplier and sector counter
+void geo_cd_set_turbo(unsigned mult);
+uint64_t geo_cd_sectors_decoded(void);
+
 #endif
@@ -36,8 +36,13 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <libchdr/chd.h>
 #include <libchdr/cdrom.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #include "geo.h"
 #include "geo_chd.h"
+#include "geo_disc.h"
 #include "geo_vfs.h"
 
 static chd_file *chd = NULL;
@@ -47,10 +52,48 @@ static geo_chd_track_t tracks[GEO_CHD_MAX_TRACKS];
 static unsigned num_tracks = 0;
 static uint32_t leadout_lba = 0;
 
-// Hunk buffer for reading sectors
+// Hunk buffer for synchronous reads on the emulation thread
 static uint8_t *hunkbuf = NULL;
 static uint32_t hunksize = 0;
-static int32_t cached_hunk = -1;
+
+/* Decompressed hunk cache. Data and CDDA reads are interleaved during
+   gameplay, so several hunks are kept with least recently used eviction
+   rather than a single cached hunk which both streams would thrash.
+*/
+typedef struct _chd_slot_t {
+    int32_t hunk;   // Hunk number held in this slot, -1 if empty
+    uint32_t used;  // LRU timestamp
+    uint8_t *data;
+} chd_slot_t;
+
+static chd_slot_t slots[GEO_CHD_CACHE_HUNKS];
+static uint8_t *slotbuf = NULL;
+static uint32_t lru_clock = 0;
+
+#ifdef HAVE_THREADS
+/* Hunks are decompressed ahead of the current read position by a worker
+   thread, so LZMA/FLAC decompression stays off the emulation thread. The
+   cache lock guards the slots and request queue, while the read lock
+   serializes access to libchdr, which is not reentrant.
+*/
+static sthread_t *prefetch_thread = NULL;
+static slock_t *cache_lock = NULL;
+static slock_t *read_lock = NULL;
+static scond_t *prefetch_cond = NULL;
+static int prefetch_quit = 0;
+
+static int32_t prefetch_queue[GEO_CHD_PREFETCH_QUEUE];
+static unsigned prefetch_head = 0;
+static unsigned prefetch_count = 0;
+static uint8_t *prefetchbuf = NULL;
+#endif
+
+// Directory for cached track indexes, NULL if caching is disabled
+static char *index_dir = NULL;
+
+#define INDEX_MAGIC     0x58444347 // "GCDX"
+#define INDEX_VERSION   1
+#define INDEX_TRACKSZ   18 // Serialized size of one track entry
 
 // Frame size: 2352 raw + 96 subcode = 2448
 #define FRAME_SIZE CD_FRAME_SIZE // 2352 + 96 = 2448
@@ -171,6 +214,268 @@ static int geo_chd_parse_toc(void) {
     return num_tracks > 0;
 }
 
+// Find the slot holding a hunk and mark it as recently used - call locked
+static chd_slot_t* geo_chd_cache_find(int32_t hunk) {
+    for (unsigned i = 0; i < GEO_CHD_CACHE_HUNKS; ++i) {
+        if (slots[i].hunk == hunk) {
+            slots[i].used = ++lru_clock;
+            return &slots[i];
+        }
+    }
+    return NULL;
+}
+
+// Copy a decompressed hunk into the least recently used slot - call locked
+static void geo_chd_cache_insert(int32_t hunk, const uint8_t *data) {
+    chd_slot_t *victim = &slots[0];
+
+    for (unsigned i = 0; i < GEO_CHD_CACHE_HUNKS; ++i) {
+        if (slots[i].hunk == hunk)
+            return; // Already inserted by the other thread
+        if (slots[i].hunk < 0) {
+            victim = &slots[i];
+            break;
+        }
+        if (slots[i].used < victim->used)
+            victim = &slots[i];
+    }
+
+    memcpy(victim->data, data, hunksize);
+    victim->hunk = hunk;
+    victim->used = ++lru_clock;
+}
+
+static void geo_chd_cache_clear(void) {
+    for (unsigned i = 0; i < GEO_CHD_CACHE_HUNKS; ++i) {
+        slots[i].hunk = -1;
+        slots[i].used = 0;
+    }
+    lru_clock = 0;
+}
+
+#ifdef HAVE_THREADS
+static void geo_chd_prefetch_worker(void *arg) {
+    (void)arg;
+
+    slock_lock(cache_lock);
+
+    while (!prefetch_quit) {
+        if (!prefetch_count) {
+            scond_wait(prefetch_cond, cache_lock);
+            continue;
+        }
+
+        int32_t hunk = prefetch_queue[prefetch_head];
+        prefetch_head = (prefetch_head + 1) % GEO_CHD_PREFETCH_QUEUE;
+        --prefetch_count;
+
+        if (geo_chd_cache_find(hunk))
+            continue;
+
+        // Decompress without holding the cache lock
+        slock_unlock(cache_lock);
+        slock_lock(read_lock);
+        chd_error err = chd_read(chd, hunk, prefetchbuf);
+        slock_unlock(read_lock);
+        slock_lock(cache_lock);
+
+        if (err == CHDERR_NONE)
+            geo_chd_cache_insert(hunk, prefetchbuf);
+    }
+
+    slock_unlock(cache_lock);
+}
+
+// Queue the hunks following the current one for decompression - call locked
+static void geo_chd_prefetch(int32_t hunk) {
+    int32_t last = (int32_t)header->totalhunks - 1;
+    int queued = 0;
+
+    for (int32_t h = hunk + 1; h <= hunk + GEO_CHD_PREFETCH && h <= last; ++h) {
+        int pending = 0;
+
+        for (unsigned i = 0; i < GEO_CHD_CACHE_HUNKS; ++i) {
+            if (slots[i].hunk == h) {
+                pending = 1;
+                break;
+            }
+        }
+
+        for (unsigned i = 0; i < prefetch_count && !pending; ++i) {
+            if (prefetch_queue[(prefetch_head + i) % GEO_CHD_PREFETCH_QUEUE]
+                == h)
+                pending = 1;
+        }
+
+        if (pending)
+            continue;
+
+        if (prefetch_count == GEO_CHD_PREFETCH_QUEUE) // Drop the oldest request
+            prefetch_head = (prefetch_head + 1) % GEO_CHD_PREFETCH_QUEUE;
+        else
+            ++prefetch_count;
+
+        prefetch_queue[(prefetch_head + prefetch_count - 1) %
+            GEO_CHD_PREFETCH_QUEUE] = h;
+        queued = 1;
+    }
+
+    if (queued)
+        scond_signal(prefetch_cond);
+}
+
+static int geo_chd_prefetch_start(void) {
+    prefetchbuf = (uint8_t*)calloc(1, hunksize);
+    cache_lock = slock_new();
+    read_lock = slock_new();
+    prefetch_cond = scond_new();
+
+    if (!prefetchbuf || !cache_lock || !read_lock || !prefetch_cond)
+        return 0;
+
+    prefetch_quit = 0;
+    prefetch_head = prefetch_count = 0;
+    prefetch_thread = sthread_create(geo_chd_prefetch_worker, NULL);
+
+    return prefetch_thread != NULL;
+}
+
+static void geo_chd_prefetch_stop(void) {
+    if (prefetch_thread) {
+        slock_lock(cache_lock);
+        prefetch_quit = 1;
+        scond_signal(prefetch_cond);
+        slock_unlock(cache_lock);
+        sthread_join(prefetch_thread);
+        prefetch_thread = NULL;
+    }
+
+    if (prefetch_cond) {
+        scond_free(prefetch_cond);
+        prefetch_cond = NULL;
+    }
+
+    if (read_lock) {
+        slock_free(read_lock);
+        read_lock = NULL;
+    }
+
+    if (cache_lock) {
+        slock_free(cache_lock);
+        cache_lock = NULL;
+    }
+
+    if (prefetchbuf) {
+        free(prefetchbuf);
+        prefetchbuf = NULL;
+    }
+}
+#endif
+
+static void geo_chd_put32(uint8_t *p, uint32_t v) {
+    p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+static uint32_t geo_chd_get32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* The header SHA1 covers both the data and the metadata, so it identifies
+   the track layout exactly. Returns 0 if the image carries no checksum.
+*/
+static int geo_chd_index_path(char *path, size_t pathsz) {
+    static const uint8_t zero[20] = { 0 };
+    if (!index_dir || !memcmp(header->sha1, zero, sizeof(zero)))
+        return 0;
+
+    char hex[41];
+    for (unsigned i = 0; i < 20; ++i)
+        snprintf(&hex[i << 1], 3, "%02x", header->sha1[i]);
+
+    snprintf(path, pathsz, "%s/%s.cdx", index_dir, hex);
+    return 1;
+}
+
+// Load a cached track index in place of parsing the CHD metadata
+static int geo_chd_index_load(void) {
+    char path[1024];
+    if (!geo_chd_index_path(path, sizeof(path)))
+        return 0;
+
+    size_t sz = 0;
+    uint8_t *data = (uint8_t*)geo_vfs_read_file(path, &sz);
+    if (!data)
+        return 0;
+
+    unsigned count = sz >= 16 ? geo_chd_get32(&data[8]) : 0;
+    if (sz < 16 || geo_chd_get32(&data[0]) != INDEX_MAGIC ||
+        geo_chd_get32(&data[4]) != INDEX_VERSION || !count ||
+        count > GEO_CHD_MAX_TRACKS || sz != 16 + (count * INDEX_TRACKSZ)) {
+        free(data);
+        return 0;
+    }
+
+    memset(tracks, 0, sizeof(tracks));
+    for (unsigned i = 0; i < count; ++i) {
+        const uint8_t *p = &data[16 + (i * INDEX_TRACKSZ)];
+        tracks[i].start = geo_chd_get32(&p[0]);
+        tracks[i].chd_start = geo_chd_get32(&p[4]);
+        tracks[i].frames = geo_chd_get32(&p[8]);
+        tracks[i].pregap = geo_chd_get32(&p[12]);
+        tracks[i].type = p[16];
+        tracks[i].raw = p[17];
+    }
+
+    num_tracks = count;
+    leadout_lba = geo_chd_get32(&data[12]);
+    free(data);
+
+    geo_log(GEO_LOG_DBG, "CHD track index loaded from cache: %s\n", path);
+    return 1;
+}
+
+static void geo_chd_index_save(void) {
+    char path[1024];
+    if (!geo_chd_index_path(path, sizeof(path)))
+        return;
+
+    uint8_t data[16 + (GEO_CHD_MAX_TRACKS * INDEX_TRACKSZ)];
+    geo_chd_put32(&data[0], INDEX_MAGIC);
+    geo_chd_put32(&data[4], INDEX_VERSION);
+    geo_chd_put32(&data[8], num_tracks);
+    geo_chd_put32(&data[12], leadout_lba);
+
+    for (unsigned i = 0; i < num_tracks; ++i) {
+        uint8_t *p = &data[16 + (i * INDEX_TRACKSZ)];
+        geo_chd_put32(&p[0], tracks[i].start);
+        geo_chd_put32(&p[4], tracks[i].chd_start);
+        geo_chd_put32(&p[8], tracks[i].frames);
+        geo_chd_put32(&p[12], tracks[i].pregap);
+        p[16] = tracks[i].type;
+        p[17] = tracks[i].raw;
+    }
+
+    void *file = geo_vfs_open(path, GEO_VFS_WRITE);
+    if (!file)
+        return;
+
+    int64_t len = 16 + (num_tracks * INDEX_TRACKSZ);
+    if (geo_vfs_write(file, data, len) != len)
+        geo_log(GEO_LOG_WRN, "Failed to write CHD track index: %s\n", path);
+    geo_vfs_close(file);
+}
+
+void geo_chd_set_index_dir(const char *dir) {
+    free(index_dir);
+    index_dir = NULL;
+
+    if (dir && dir[0]) {
+        index_dir = (char*)malloc(strlen(dir) + 1);
+        if (index_dir)
+            strcpy(index_dir, dir);
+    }
+}
+
 /* libchdr accesses the CHD through a core_file, so all that is required to
    keep file access out of the core is a wrapper over the VFS layer.
 */
@@ -250,19 +555,32 @@ int geo_chd_open(const char *path) {
     if (frames_per_hunk == 0) frames_per_hunk = 1;
 
     hunkbuf = (uint8_t*)calloc(1, hunksize);
-    if (!hunkbuf) {
-        chd_close(chd);
-        chd = NULL;
+    slotbuf = (uint8_t*)calloc(GEO_CHD_CACHE_HUNKS, hunksize);
+    if (!hunkbuf || !slotbuf) {
+        geo_chd_close();
         return 0;
     }
 
-    cached_hunk = -1;
+    for (unsigned i = 0; i < GEO_CHD_CACHE_HUNKS; ++i)
+        slots[i].data = slotbuf + (i * hunksize);
+    geo_chd_cache_clear();
 
-    if (!geo_chd_parse_toc()) {
-        geo_log(GEO_LOG_ERR, "Failed to parse CHD TOC\n");
-        geo_chd_close();
-        return 0;
+    if (!geo_chd_index_load()) {
+        if (!geo_chd_parse_toc()) {
+            geo_log(GEO_LOG_ERR, "Failed to parse CHD TOC\n");
+            geo_chd_close();
+            return 0;
+        }
+        geo_chd_index_save();
+    }
+
+#ifdef HAVE_THREADS
+    // Reads still work synchronously if the worker cannot be started
+    if (!geo_chd_prefetch_start()) {
+        geo_log(GEO_LOG_WRN, "CHD prefetch unavailable\n");
+        geo_chd_prefetch_stop();
     }
+#endif
 
     geo_log(GEO_LOG_INF, "CHD opened: %u tracks, leadout at LBA %u\n",
         num_tracks, leadout_lba);
@@ -271,6 +589,10 @@ int geo_chd_open(const char *path) {
 }
 
 void geo_chd_close(void) {
+#ifdef HAVE_THREADS
+    geo_chd_prefetch_stop(); // The worker must be idle before libchdr closes
+#endif
+
     if (chd) {
         chd_close(chd);
         chd = NULL;
@@ -281,47 +603,100 @@ void geo_chd_close(void) {
         hunkbuf = NULL;
     }
 
+    if (slotbuf) {
+        free(slotbuf);
+        slotbuf = NULL;
+    }
+
+    for (unsigned i = 0; i < GEO_CHD_CACHE_HUNKS; ++i)
+        slots[i].data = NULL;
+    geo_chd_cache_clear();
+
     header = NULL;
     num_tracks = 0;
     leadout_lba = 0;
-    cached_hunk = -1;
 }
 
 static int geo_chd_read_frame(uint32_t lba, uint8_t *frame) {
     if (!chd || !hunkbuf)
         return 0;
 
-    uint32_t hunknum = lba / frames_per_hunk;
+    int32_t hunknum = lba / frames_per_hunk;
     uint32_t frameoff = lba % frames_per_hunk;
+    chd_slot_t *slot;
+
+#ifdef HAVE_THREADS
+    if (prefetch_thread) {
+        slock_lock(cache_lock);
+        geo_chd_prefetch(hunknum);
+        slot = geo_chd_cache_find(hunknum);
+        if (slot) {
+            memcpy(frame, slot->data + (frameoff * FRAME_SIZE),
+                GEO_CHD_SECTOR_SIZE);
+            slock_unlock(cache_lock);
+            return 1;
+        }
+        slock_unlock(cache_lock);
+
+        /* Cache miss - wait for any decompression in progress, which may be
+           the hunk being requested, then check again before reading.
+        */
+        slock_lock(read_lock);
+        slock_lock(cache_lock);
+        slot = geo_chd_cache_find(hunknum);
+        if (slot) {
+            memcpy(frame, slot->data + (frameoff * FRAME_SIZE),
+                GEO_CHD_SECTOR_SIZE);
+            slock_unlock(cache_lock);
+            slock_unlock(read_lock);
+            return 1;
+        }
+        slock_unlock(cache_lock);
 
-    // Cache hunk reads
-    if ((int32_t)hunknum != cached_hunk) {
         chd_error err = chd_read(chd, hunknum, hunkbuf);
+        slock_unlock(read_lock);
+
         if (err != CHDERR_NONE) {
-            geo_log(GEO_LOG_ERR, "CHD read error at hunk %u: %d\n",
+            geo_log(GEO_LOG_ERR, "CHD read error at hunk %d: %d\n",
                 hunknum, err);
-            cached_hunk = -1;
             return 0;
         }
-        cached_hunk = hunknum;
+
+        slock_lock(cache_lock);
+        geo_chd_cache_insert(hunknum, hunkbuf);
+        slock_unlock(cache_lock);
+
+        memcpy(frame, hunkbuf + (frameoff * FRAME_SIZE), GEO_CHD_SECTOR_SIZE);
+        return 1;
     }
+#endif
 
-    memcpy(frame, hunkbuf + (frameoff * FRAME_SIZE), GEO_CHD_SECTOR_SIZE);
+    slot = geo_chd_cache_find(hunknum);
+    if (!slot) {
+        chd_error err = chd_read(chd, hunknum, hunkbuf);
+        if (err != CHDERR_NONE) {
+            geo_log(GEO_LOG_ERR, "CHD read error at hunk %d: %d\n",
+                hunknum, err);
+            return 0;
+        }
+        geo_chd_cache_insert(hunknum, hunkbuf);
+        slot = geo_chd_cache_find(hunknum);
+    }
+
+    memcpy(frame, slot->data + (frameoff * FRAME_SIZE), GEO_CHD_SECTOR_SIZE);
     return 1;
 }
 
 // Convert disc LBA (what the BIOS uses) to CHD LBA (for reading data)
 // The disc has pregaps that may not exist in the CHD data.
 static uint32_t disc_to_chd_lba(uint32_t disc_lba) {
-    // Find which track this disc LBA falls in
-    for (unsigned i = num_tracks; i > 0; --i) {
-        if (disc_lba >= tracks[i - 1].start) {
-            uint32_t offset = disc_lba - tracks[i - 1].start;
-            return tracks[i - 1].chd_start + offset;
-        }
-    }
+    const geo_chd_track_t *t = &tracks[geo_disc_lookup_track(disc_lba) - 1];
+
     // Before track 1 — for track 1, cd_start and chd_start are both 0
-    return disc_lba;
+    if (disc_lba < t->start)
+        return disc_lba;
+
+    return t->chd_start + (disc_lba - t->start);
 }
 
 int geo_chd_read_sector(uint32_t disc_lba, uint8_t *buf) {
@@ -38,6 +38,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define GEO_CHD_TRACK_DATA  0
 #define GEO_CHD_TRACK_AUDIO 1
 
+#define GEO_CHD_CACHE_HUNKS     32 // Decompressed hunks kept in memory
+#define GEO_CHD_PREFETCH        4  // Hunks decompressed ahead of each read
+#define GEO_CHD_PREFETCH_QUEUE  16 // Outstanding prefetch requests
+
 typedef struct _geo_chd_track_t {
     uint32_t start;     // CD position (what BIOS sees) - index 1 start
     uint32_t chd_start; // CHD position (for data reading)
@@ -47,6 +51,11 @@ typedef struct _geo_chd_track_t {
     uint8_t raw;        // 0 = MODE1 (2048-byte), 1 = MODE1_RAW (2352-byte)
 } geo_chd_track_t;
 
+/* Cache parsed track layouts as small files in this directory, keyed by the
+   image's SHA1, so reopening an image skips metadata parsing. NULL disables.
+*/
+void geo_chd_set_index_dir(const char *dir);
+
 int geo_chd_open(const char *path);
 void geo_chd_close(void);
 
@@ -38,6 +38,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define DR_FLAC_NO_STDIO // All file access goes through the VFS layer
 #include <dr/dr_flac.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #include "geo.h"
 #include "geo_cue.h"
 #include "geo_disc.h"
@@ -54,10 +58,14 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 typedef struct {
     void *fp;           // VFS file handle
+    uint8_t *map;       // Memory mapping of the whole file, if available
+    size_t mapsz;
     char path[1024];
     int type;           // FTYPE_*
     uint32_t data_off;  // Offset to PCM data (WAV header skip)
     drflac *flac;       // FLAC decoder handle (FTYPE_FLAC only)
+    void *sync_fp;      // Second handle and decoder for exact reads, opened
+    drflac *sync_flac;  // on first use so they never disturb playback
 } cue_file_t;
 
 typedef struct {
@@ -77,9 +85,52 @@ static cue_track_t tracks[MAX_TRACKS];
 static unsigned num_tracks = 0;
 static uint32_t leadout_lba = 0;
 
-// FLAC last-read state to avoid redundant seeks
-static int flac_last_track = -1;
-static uint64_t flac_last_frame = 0;
+// FLAC decoder position, to avoid redundant seeks
+typedef struct {
+    int track;      // Track last decoded, -1 if none
+    uint64_t frame; // PCM frame following the last decode
+} cue_flac_pos_t;
+
+static cue_flac_pos_t flac_pos = { -1, 0 };      // Streaming decoders
+static cue_flac_pos_t flac_sync_pos = { -1, 0 }; // Exact-read decoders
+
+#ifdef HAVE_THREADS
+/* FLAC decode-ahead. A worker thread decodes the sectors following the last
+   CDDA read into a ring, so the mixer only copies out of it. When a read
+   falls outside the ring (a seek, a track change, or the decoder falling
+   behind) the ring is restarted at the new position and silence is returned
+   until it fills, with the first sector after the silence faded in. Once the
+   worker is running, it is the only user of the streaming FLAC decoders.
+
+   Whenever the ring has nothing left to do, the worker also decodes the first
+   few sectors of the track being played and of the one after it. Looping
+   music and moving on to the next track both start from one of these, so a
+   read landing on them is served at once while the ring restarts behind it.
+*/
+#define FLAC_RING_SECTORS 32
+#define FLAC_HEAD_SECTORS 4
+
+typedef struct {
+    int track;      // Track the sectors belong to, -1 if unused
+    unsigned count; // Sectors decoded so far
+    uint8_t data[FLAC_HEAD_SECTORS][GEO_DISC_SECTOR_SIZE];
+} cue_flac_head_t;
+
+static sthread_t *flac_thread = NULL;
+static slock_t *flac_lock = NULL;
+static scond_t *flac_cond = NULL; // Signals the worker: space or a restart
+static int flac_quit = 0;
+
+static uint8_t flac_ring[FLAC_RING_SECTORS][GEO_DISC_SECTOR_SIZE];
+static int flac_ring_track = -1;    // Track being decoded, -1 if idle
+static uint32_t flac_ring_lba = 0;  // LBA of the oldest sector in the ring
+static unsigned flac_ring_head = 0;
+static unsigned flac_ring_count = 0;
+static unsigned flac_ring_gen = 0;  // Bumped on restart to discard stale work
+static int flac_ring_fade = 0;      // Fade in the next sector read
+
+static cue_flac_head_t flac_heads[2];
+#endif
 
 // Compare two strings ignoring case in a Jolly Good manner
 static int strjcasecmp(const char *a, const char *b, size_t n) {
@@ -199,6 +250,11 @@ static int geo_cue_open_file(int idx) {
         }
     }
 
+    /* Map uncompressed files so sector reads become pointer arithmetic. The
+       file handle stays open for size queries and as the fallback.
+    */
+    f->map = (uint8_t*)geo_vfs_map_file(f->path, &f->mapsz);
+
     return 1;
 }
 
@@ -234,12 +290,254 @@ static uint32_t geo_cue_file_size_frames(int file_idx) {
     return (uint32_t)(size / sector_sz);
 }
 
+// Decode one sector of a FLAC track, seeking only when access is not linear
+static int geo_cue_flac_decode(drflac *flac, cue_flac_pos_t *pos, int ti,
+    uint32_t track_offset, int16_t *buf) {
+    // 588 stereo PCM frames per CD sector
+    uint64_t target_frame = (uint64_t)track_offset * 588;
+
+    // Only seek if not sequential
+    if (pos->track != ti || pos->frame != target_frame)
+        drflac_seek_to_pcm_frame(flac, target_frame);
+
+    drflac_uint64 read = drflac_read_pcm_frames_s16(flac, 588,
+                                                     (drflac_int16*)buf);
+    if (read < 588)
+        memset(buf + read * 2, 0, (588 - read) * 2 * sizeof(int16_t));
+
+    pos->track = ti;
+    pos->frame = target_frame + 588;
+    return 1;
+}
+
+#ifdef HAVE_THREADS
+// Number of sectors to prefetch from the start of a track
+static unsigned geo_cue_flac_head_len(int ti) {
+    return tracks[ti].frames < FLAC_HEAD_SECTORS ?
+        tracks[ti].frames : FLAC_HEAD_SECTORS;
+}
+
+/* Find the head of the current or next track which still needs decoding,
+   claiming a slot for it if needed - call locked
+*/
+static cue_flac_head_t* geo_cue_flac_head_next(int ti) {
+    for (int t = ti; t <= ti + 1 && t < (int)num_tracks; ++t) {
+        cue_file_t *f = &files[tracks[t].file_idx];
+        if (tracks[t].type != GEO_DISC_TRACK_AUDIO || !f->flac)
+            continue;
+
+        cue_flac_head_t *h = NULL;
+        for (unsigned i = 0; i < 2; ++i) {
+            if (flac_heads[i].track == t)
+                h = &flac_heads[i];
+        }
+
+        if (!h) { // Reuse the slot held by neither track
+            h = &flac_heads[flac_heads[0].track == ti ||
+                flac_heads[0].track == ti + 1];
+            h->track = t;
+            h->count = 0;
+        }
+
+        if (h->count < geo_cue_flac_head_len(t))
+            return h;
+    }
+
+    return NULL;
+}
+
+static void geo_cue_flac_worker(void *arg) {
+    (void)arg;
+    int16_t sector[GEO_DISC_SECTOR_SIZE >> 1];
+
+    slock_lock(flac_lock);
+
+    while (!flac_quit) {
+        int ti = flac_ring_track;
+        uint32_t lba = flac_ring_lba + flac_ring_count;
+
+        if (ti < 0) {
+            scond_wait(flac_cond, flac_lock);
+            continue;
+        }
+
+        // With the ring full or at the end of the track, prefetch heads
+        if (flac_ring_count == FLAC_RING_SECTORS ||
+            lba - tracks[ti].start >= tracks[ti].frames) {
+            cue_flac_head_t *h = geo_cue_flac_head_next(ti);
+            if (!h) {
+                scond_wait(flac_cond, flac_lock);
+                continue;
+            }
+
+            int ht = h->track;
+            unsigned n = h->count;
+
+            slock_unlock(flac_lock);
+            geo_cue_flac_decode(files[tracks[ht].file_idx].flac, &flac_pos,
+                ht, n, sector);
+            slock_lock(flac_lock);
+
+            if (h->track == ht && h->count == n) {
+                memcpy(h->data[n], sector, GEO_DISC_SECTOR_SIZE);
+                ++h->count;
+            }
+            continue;
+        }
+
+        unsigned gen = flac_ring_gen;
+
+        slock_unlock(flac_lock);
+        geo_cue_flac_decode(files[tracks[ti].file_idx].flac, &flac_pos,
+            ti, lba - tracks[ti].start, sector);
+        slock_lock(flac_lock);
+
+        // Keep the sector only if the ring was not restarted meanwhile
+        if (gen == flac_ring_gen &&
+            lba == flac_ring_lba + flac_ring_count) {
+            memcpy(flac_ring[(flac_ring_head + flac_ring_count) %
+                FLAC_RING_SECTORS], sector, GEO_DISC_SECTOR_SIZE);
+            ++flac_ring_count;
+        }
+    }
+
+    slock_unlock(flac_lock);
+}
+
+// Restart decoding at a new position - call locked
+static void geo_cue_flac_ring_restart(int ti, uint32_t disc_lba) {
+    flac_ring_track = ti;
+    flac_ring_lba = disc_lba;
+    flac_ring_head = 0;
+    flac_ring_count = 0;
+    ++flac_ring_gen;
+    scond_signal(flac_cond);
+}
+
+/* Copy a sector out of a prefetched track head, pointing the ring just past
+   the head so it takes over once the head runs out - call locked
+*/
+static int geo_cue_flac_head_read(int ti, uint32_t disc_lba, int16_t *buf) {
+    uint32_t offset = disc_lba - tracks[ti].start;
+
+    for (unsigned i = 0; i < 2; ++i) {
+        cue_flac_head_t *h = &flac_heads[i];
+        if (h->track != ti || offset >= h->count)
+            continue;
+
+        uint32_t resume = tracks[ti].start + geo_cue_flac_head_len(ti);
+        if (flac_ring_track != ti || flac_ring_lba > resume ||
+            flac_ring_lba + flac_ring_count < resume) {
+            geo_cue_flac_ring_restart(ti, resume);
+        }
+
+        memcpy(buf, h->data[offset], GEO_DISC_SECTOR_SIZE);
+        flac_ring_fade = 0;
+        return 1;
+    }
+
+    return 0;
+}
+
+/* Read a sector through the ring. A read which misses is served from the
+   prefetched track heads if possible, otherwise it restarts the ring and
+   returns silence.
+*/
+static int geo_cue_flac_ring_read(int ti, uint32_t disc_lba, int16_t *buf) {
+    slock_lock(flac_lock);
+
+    if (flac_ring_track != ti || disc_lba < flac_ring_lba ||
+        disc_lba >= flac_ring_lba + flac_ring_count) {
+
+        if (geo_cue_flac_head_read(ti, disc_lba, buf)) {
+            slock_unlock(flac_lock);
+            return 1;
+        }
+
+        /* Restart past this sector, which also lets the decoder catch up
+           when the read was just past the filled part of the ring
+        */
+        geo_cue_flac_ring_restart(ti, disc_lba + 1);
+        flac_ring_fade = 1;
+        slock_unlock(flac_lock);
+        memset(buf, 0, GEO_DISC_SECTOR_SIZE);
+        return 1;
+    }
+
+    // Drop anything older than the requested sector, then consume it
+    unsigned skip = disc_lba - flac_ring_lba;
+    flac_ring_head = (flac_ring_head + skip) % FLAC_RING_SECTORS;
+    flac_ring_count -= skip;
+    memcpy(buf, flac_ring[flac_ring_head], GEO_DISC_SECTOR_SIZE);
+    flac_ring_head = (flac_ring_head + 1) % FLAC_RING_SECTORS;
+    flac_ring_count--;
+    flac_ring_lba = disc_lba + 1;
+
+    int fade = flac_ring_fade;
+    flac_ring_fade = 0;
+
+    scond_signal(flac_cond);
+    slock_unlock(flac_lock);
+
+    // Ramp in after a restart to avoid a click against the silence
+    if (fade) {
+        for (unsigned i = 0; i < 588; ++i) {
+            buf[i << 1] = (buf[i << 1] * (int32_t)i) / 588;
+            buf[(i << 1) + 1] = (buf[(i << 1) + 1] * (int32_t)i) / 588;
+        }
+    }
+
+    return 1;
+}
+
+static void geo_cue_flac_stop(void) {
+    if (flac_thread) {
+        slock_lock(flac_lock);
+        flac_quit = 1;
+        scond_signal(flac_cond);
+        slock_unlock(flac_lock);
+        sthread_join(flac_thread);
+        flac_thread = NULL;
+    }
+
+    if (flac_cond) {
+        scond_free(flac_cond);
+        flac_cond = NULL;
+    }
+
+    if (flac_lock) {
+        slock_free(flac_lock);
+        flac_lock = NULL;
+    }
+
+    flac_ring_track = -1;
+    flac_ring_count = 0;
+}
+
+static void geo_cue_flac_start(void) {
+    flac_lock = slock_new();
+    flac_cond = scond_new();
+    flac_quit = 0;
+    flac_ring_track = -1;
+    flac_ring_count = 0;
+    flac_heads[0].track = flac_heads[1].track = -1;
+
+    if (flac_lock && flac_cond)
+        flac_thread = sthread_create(geo_cue_flac_worker, NULL);
+
+    if (!flac_thread) {
+        geo_log(GEO_LOG_WRN, "CUE: FLAC decode-ahead unavailable\n");
+        geo_cue_flac_stop();
+    }
+}
+#endif
+
 // Open a cue sheet
 int geo_cue_open(const char *path) {
     num_files = 0;
     num_tracks = 0;
     leadout_lba = 0;
-    flac_last_track = -1;
+    flac_pos.track = flac_sync_pos.track = -1;
     memset(files, 0, sizeof(files));
     memset(tracks, 0, sizeof(tracks));
 
@@ -480,16 +778,42 @@ int geo_cue_open(const char *path) {
     geo_log(GEO_LOG_INF, "CUE opened: %u tracks, %u files, leadout at LBA %u\n",
         num_tracks, num_files, leadout_lba);
 
+#ifdef HAVE_THREADS
+    for (unsigned i = 0; i < num_files; ++i) {
+        if (files[i].flac) {
+            geo_cue_flac_start();
+            break;
+        }
+    }
+#endif
+
     return 1;
 }
 
 // Close a cue sheet
 void geo_cue_close(void) {
+#ifdef HAVE_THREADS
+    geo_cue_flac_stop(); // The worker must be idle before decoders close
+#endif
+
     for (unsigned i = 0; i < num_files; ++i) {
         if (files[i].flac) { // Decoder holds the file handle, close it first
             drflac_close(files[i].flac);
             files[i].flac = NULL;
         }
+        if (files[i].sync_flac) {
+            drflac_close(files[i].sync_flac);
+            files[i].sync_flac = NULL;
+        }
+        if (files[i].sync_fp) {
+            geo_vfs_close(files[i].sync_fp);
+            files[i].sync_fp = NULL;
+        }
+        if (files[i].map) {
+            geo_vfs_unmap_file(files[i].map, files[i].mapsz);
+            files[i].map = NULL;
+            files[i].mapsz = 0;
+        }
         if (files[i].fp) {
             geo_vfs_close(files[i].fp);
             files[i].fp = NULL;
@@ -498,16 +822,40 @@ void geo_cue_close(void) {
     num_files = 0;
     num_tracks = 0;
     leadout_lba = 0;
-    flac_last_track = -1;
+    flac_pos.track = flac_sync_pos.track = -1;
 }
 
-// Find which track a disc LBA belongs to
+// Find which track a disc LBA belongs to, using the shared disc index
 static int geo_cue_find_track(uint32_t disc_lba) {
-    for (int i = (int)num_tracks - 1; i >= 0; --i) {
-        if (disc_lba >= tracks[i].start)
-            return i;
-    }
-    return 0;
+    return (int)geo_disc_lookup_track(disc_lba) - 1;
+}
+
+// Byte offset of a data sector's user data within its file
+static uint64_t geo_cue_sector_offset(const cue_track_t *t, uint32_t disc_lba) {
+    uint32_t track_offset = disc_lba - t->start;
+    uint64_t byte_offset = t->file_offset +
+                           (uint64_t)track_offset * t->sector_size;
+
+    // Raw 2352: skip 16-byte header. ISO 2048: read directly.
+    if (t->sector_size == GEO_DISC_SECTOR_SIZE)
+        byte_offset += 16;
+
+    return byte_offset;
+}
+
+// Return a pointer to a sector's user data in a mapped file, or NULL
+const uint8_t* geo_cue_sector_ptr(uint32_t disc_lba) {
+    cue_track_t *t = &tracks[geo_cue_find_track(disc_lba)];
+    cue_file_t *f = &files[t->file_idx];
+
+    if (!f->map || f->type == FTYPE_FLAC)
+        return NULL;
+
+    uint64_t byte_offset = geo_cue_sector_offset(t, disc_lba);
+    if (byte_offset + GEO_DISC_DATA_SIZE > f->mapsz)
+        return NULL;
+
+    return f->map + byte_offset;
 }
 
 // Read a sector worth of disc data
@@ -519,13 +867,14 @@ int geo_cue_read_sector(uint32_t disc_lba, uint8_t *buf) {
     if (!f->fp || f->type == FTYPE_FLAC)
         return 0;
 
-    uint32_t track_offset = disc_lba - t->start;
-    uint64_t byte_offset = t->file_offset +
-                           (uint64_t)track_offset * t->sector_size;
+    uint64_t byte_offset = geo_cue_sector_offset(t, disc_lba);
 
-    // Raw 2352: skip 16-byte header. ISO 2048: read directly.
-    if (t->sector_size == GEO_DISC_SECTOR_SIZE)
-        byte_offset += 16;
+    if (f->map) {
+        if (byte_offset + GEO_DISC_DATA_SIZE > f->mapsz)
+            return 0;
+        memcpy(buf, f->map + byte_offset, GEO_DISC_DATA_SIZE);
+        return 1;
+    }
 
     if (geo_vfs_seek(f->fp, (int64_t)byte_offset, GEO_VFS_SEEK_SET) < 0)
         return 0;
@@ -547,24 +896,12 @@ int geo_cue_read_audio(uint32_t disc_lba, int16_t *buf) {
     if (f->type == FTYPE_FLAC) {
         if (!f->flac)
             return 0;
-
-        // 588 stereo PCM frames per CD sector
-        uint64_t target_frame = (uint64_t)track_offset * 588;
-
-        // Only seek if not sequential
-        if (flac_last_track != ti ||
-            flac_last_frame != target_frame) {
-            drflac_seek_to_pcm_frame(f->flac, target_frame);
-        }
-
-        drflac_uint64 read = drflac_read_pcm_frames_s16(f->flac, 588,
-                                                         (drflac_int16*)buf);
-        if (read < 588)
-            memset(buf + read * 2, 0, (588 - read) * 2 * sizeof(int16_t));
-
-        flac_last_track = ti;
-        flac_last_frame = target_frame + 588;
-        return 1;
+#ifdef HAVE_THREADS
+        if (flac_thread)
+            return geo_cue_flac_ring_read(ti, disc_lba, buf);
+#endif
+        return geo_cue_flac_decode(f->flac, &flac_pos, ti, track_offset,
+            buf);
     }
 
     if (!f->fp)
@@ -580,12 +917,21 @@ int geo_cue_read_audio(uint32_t disc_lba, int16_t *buf) {
                       (uint64_t)track_offset * t->sector_size;
     }
 
+    // BIN/WAV audio is little-endian — no byte-swap needed
+    if (f->map) {
+        if (byte_offset + GEO_DISC_SECTOR_SIZE > f->mapsz) {
+            memset(buf, 0, GEO_DISC_SECTOR_SIZE);
+            return 0;
+        }
+        memcpy(buf, f->map + byte_offset, GEO_DISC_SECTOR_SIZE);
+        return 1;
+    }
+
     if (geo_vfs_seek(f->fp, (int64_t)byte_offset, GEO_VFS_SEEK_SET) < 0) {
         memset(buf, 0, GEO_DISC_SECTOR_SIZE);
         return 0;
     }
 
-    // BIN/WAV audio is little-endian — no byte-swap needed
     if (geo_vfs_read(f->fp, buf, GEO_DISC_SECTOR_SIZE) !=
         GEO_DISC_SECTOR_SIZE) {
         memset(buf, 0, GEO_DISC_SECTOR_SIZE);
@@ -595,6 +941,38 @@ int geo_cue_read_audio(uint32_t disc_lba, int16_t *buf) {
     return 1;
 }
 
+/* Read CDDA audio exactly, never returning filler. Used by callers which need
+   every sector, such as the disc preloader, rather than streaming playback.
+*/
+int geo_cue_read_audio_sync(uint32_t disc_lba, int16_t *buf) {
+    int ti = geo_cue_find_track(disc_lba);
+    cue_file_t *f = &files[tracks[ti].file_idx];
+
+    if (f->type != FTYPE_FLAC || !f->flac)
+        return geo_cue_read_audio(disc_lba, buf);
+
+    // Decode on a separate handle so the streaming decoder keeps its place
+    if (!f->sync_flac) {
+        f->sync_fp = geo_vfs_open(f->path, GEO_VFS_READ);
+        if (f->sync_fp) {
+            f->sync_flac = drflac_open(geo_cue_flac_read, geo_cue_flac_seek,
+                geo_cue_flac_tell, f->sync_fp, NULL);
+        }
+        if (!f->sync_flac) {
+            geo_log(GEO_LOG_ERR, "CUE: Failed to open FLAC: %s\n", f->path);
+            if (f->sync_fp) {
+                geo_vfs_close(f->sync_fp);
+                f->sync_fp = NULL;
+            }
+            memset(buf, 0, GEO_DISC_SECTOR_SIZE);
+            return 0;
+        }
+    }
+
+    return geo_cue_flac_decode(f->sync_flac, &flac_sync_pos, ti,
+        disc_lba - tracks[ti].start, buf);
+}
+
 unsigned geo_cue_num_tracks(void) {
     return num_tracks;
 }
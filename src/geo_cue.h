@@ -36,6 +36,8 @@ void geo_cue_close(void);
 
 int geo_cue_read_sector(uint32_t disc_lba, uint8_t *buf);
 int geo_cue_read_audio(uint32_t disc_lba, int16_t *buf);
+int geo_cue_read_audio_sync(uint32_t disc_lba, int16_t *buf);
+const uint8_t* geo_cue_sector_ptr(uint32_t disc_lba);
 
 unsigned geo_cue_num_tracks(void);
 int geo_cue_track_is_audio(unsigned track);
@@ -31,8 +31,13 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <ctype.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #include "geo.h"
 #include "geo_disc.h"
 #include "geo_cue.h"
@@ -44,6 +49,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // Function pointer dispatch — set once at open, zero overhead per call
 static int (*fn_read_sector)(uint32_t, uint8_t*);
 static int (*fn_read_audio)(uint32_t, int16_t*);
+static int (*fn_read_audio_sync)(uint32_t, int16_t*); // Never returns filler
+static const uint8_t* (*fn_sector_ptr)(uint32_t);
 static unsigned (*fn_num_tracks)(void);
 static int (*fn_track_is_audio)(unsigned);
 static uint32_t (*fn_track_start)(unsigned);
@@ -51,6 +58,89 @@ static uint32_t (*fn_track_frames)(unsigned);
 static uint32_t (*fn_leadout)(void);
 static void (*fn_close)(void);
 
+/* Track index, built once at open time. Each entry covers the LBAs from a
+   track's start up to the next track's start (or the lead-out), so any LBA
+   maps to exactly one entry; LBAs before the first track map to it. Lookups
+   from the emulation thread check the last hit first, which covers nearly
+   every call as reads are mostly sequential, then fall back to a binary
+   search. Backends are also called from the read ahead and preload threads,
+   so their lookups always search and leave the hint alone.
+*/
+typedef struct _disc_index_t {
+    uint32_t start;
+    uint32_t end;
+    uint32_t frames;
+    uint8_t audio;
+} disc_index_t;
+
+static disc_index_t disc_index[GEO_DISC_MAX_TRACKS];
+static unsigned index_count = 0;
+static uint32_t index_leadout = 0;
+static unsigned index_last = 0; // Last hit, emulation thread only
+
+/* Whole-disc preload. Every track is read into one contiguous image - data
+   tracks as 2048 byte user data, audio tracks as native endian samples - so
+   that once complete, sector reads are plain memory copies. The backend stays
+   open to serve any LBA not covered by a track (gaps, lead-out).
+*/
+typedef struct _preload_track_t {
+    uint32_t start;
+    uint32_t frames;
+    size_t offset;  // Byte offset of the track in the image
+    uint8_t audio;
+} preload_track_t;
+
+static int preload_enabled = 0;
+static uint8_t *preload_image = NULL;
+static preload_track_t preload_tracks[GEO_DISC_MAX_TRACKS];
+static unsigned preload_ntracks = 0;
+static uint32_t preload_total = 0; // Sectors to read
+static volatile uint32_t preload_count = 0; // Sectors read so far
+static volatile int preload_done = 0;
+static volatile int preload_quit = 0;
+
+// Backend readers, kept for LBAs outside the preloaded tracks
+static int (*be_read_sector)(uint32_t, uint8_t*);
+static int (*be_read_audio)(uint32_t, int16_t*);
+static const uint8_t* (*be_sector_ptr)(uint32_t);
+
+#ifdef HAVE_THREADS
+static sthread_t *preload_thread = NULL;
+static slock_t *preload_lock = NULL; // Serializes backend access while loading
+#endif
+
+/* Sector staging. When the backend has to read a data sector (a CHD, or a
+   BIN file which could not be mapped), a worker thread reads ahead of the
+   drive and frames each sector with its header, so the LC8951 only has to
+   copy it into its buffer. Slot N holds LBA N modulo the queue size; the
+   worker fills LBAs after the one last consumed, so the slot handed to the
+   emulation thread is never written while it is in use. A miss (a seek)
+   restarts the queue, and the sector is read synchronously.
+*/
+#ifdef HAVE_THREADS
+typedef struct _stage_slot_t {
+    uint32_t lba;
+    int valid;
+    uint8_t frame[GEO_DISC_FRAME_SIZE];
+} stage_slot_t;
+
+static stage_slot_t stage_slots[GEO_DISC_STAGE_SECTORS];
+static uint32_t stage_base = 0; // LBA consumed most recently
+static uint32_t stage_next = 0; // Next LBA for the worker to read
+static uint32_t stage_gen = 0; // Bumped on restart to discard stale reads
+static int stage_quit = 0;
+static int stage_failed = 0; // Unable to start, so always read directly
+
+static sthread_t *stage_thread = NULL;
+static slock_t *stage_lock = NULL; // Guards the queue
+static slock_t *stage_io_lock = NULL; // Serializes backend access
+static scond_t *stage_cond = NULL;
+
+// Backend readers, called with stage_io_lock held
+static int (*st_read_sector)(uint32_t, uint8_t*);
+static int (*st_read_audio)(uint32_t, int16_t*);
+#endif
+
 static int detect_backend(const char *path) {
 #ifdef HAVE_CHDR
     // Convert extension to lower case, then compare
@@ -78,6 +168,8 @@ static int detect_backend(const char *path) {
 static void clear_dispatch(void) {
     fn_read_sector = NULL;
     fn_read_audio = NULL;
+    fn_read_audio_sync = NULL;
+    fn_sector_ptr = NULL;
     fn_num_tracks = NULL;
     fn_track_is_audio = NULL;
     fn_track_start = NULL;
@@ -98,6 +190,10 @@ static int stub_read_audio(uint32_t lba, int16_t *buf) {
     (void)lba; (void)buf; return 0;
 }
 
+static const uint8_t* stub_sector_ptr(uint32_t lba) {
+    (void)lba; return NULL;
+}
+
 static int stub_track_is_audio(unsigned t) {
     (void)t; return 0;
 }
@@ -110,6 +206,366 @@ static uint32_t stub_leadout(void) {
     return 0;
 }
 
+static void index_build(void) {
+    index_count = fn_num_tracks();
+    if (index_count > GEO_DISC_MAX_TRACKS)
+        index_count = GEO_DISC_MAX_TRACKS;
+
+    index_leadout = fn_leadout();
+    index_last = 0;
+
+    for (unsigned i = 0; i < index_count; ++i) {
+        disc_index[i].start = fn_track_start(i + 1);
+        disc_index[i].frames = fn_track_frames(i + 1);
+        disc_index[i].audio = fn_track_is_audio(i + 1);
+    }
+
+    for (unsigned i = 0; i < index_count; ++i) {
+        disc_index[i].end = i + 1 < index_count ?
+            disc_index[i + 1].start : index_leadout;
+    }
+}
+
+static const preload_track_t* preload_find(uint32_t lba) {
+    unsigned track = geo_disc_find_track(lba);
+    if (track > preload_ntracks)
+        return NULL;
+
+    const preload_track_t *t = &preload_tracks[track - 1];
+    return lba >= t->start && lba - t->start < t->frames ? t : NULL;
+}
+
+static int preload_read_sector(uint32_t lba, uint8_t *buf) {
+    const preload_track_t *t = preload_find(lba);
+    if (!t || t->audio)
+        return be_read_sector(lba, buf);
+
+    memcpy(buf, preload_image + t->offset +
+        ((size_t)(lba - t->start) * GEO_DISC_DATA_SIZE), GEO_DISC_DATA_SIZE);
+    return 1;
+}
+
+static int preload_read_audio(uint32_t lba, int16_t *buf) {
+    const preload_track_t *t = preload_find(lba);
+    if (!t || !t->audio)
+        return be_read_audio(lba, buf);
+
+    memcpy(buf, preload_image + t->offset +
+        ((size_t)(lba - t->start) * GEO_DISC_SECTOR_SIZE),
+        GEO_DISC_SECTOR_SIZE);
+    return 1;
+}
+
+static const uint8_t* preload_sector_ptr(uint32_t lba) {
+    const preload_track_t *t = preload_find(lba);
+    if (!t || t->audio)
+        return be_sector_ptr(lba);
+
+    return preload_image + t->offset +
+        ((size_t)(lba - t->start) * GEO_DISC_DATA_SIZE);
+}
+
+// Read a single track sector from the backend into the image
+static int preload_sector(const preload_track_t *t, uint32_t i) {
+    if (t->audio) { // Streaming reads may return filler, so read exactly
+        return fn_read_audio_sync(t->start + i, (int16_t*)(preload_image +
+            t->offset + ((size_t)i * GEO_DISC_SECTOR_SIZE)));
+    }
+
+    return be_read_sector(t->start + i, preload_image + t->offset +
+        ((size_t)i * GEO_DISC_DATA_SIZE));
+}
+
+static void preload_run(void) {
+    for (unsigned n = 0; n < preload_ntracks; ++n) {
+        const preload_track_t *t = &preload_tracks[n];
+        for (uint32_t i = 0; i < t->frames; ++i) {
+            if (preload_quit)
+                return;
+#ifdef HAVE_THREADS
+            if (preload_lock) slock_lock(preload_lock);
+#endif
+            int ok = preload_sector(t, i);
+#ifdef HAVE_THREADS
+            if (preload_lock) slock_unlock(preload_lock);
+#endif
+            if (!ok) {
+                geo_log(GEO_LOG_WRN, "Disc preload failed at LBA %u\n",
+                    t->start + i);
+                return;
+            }
+            ++preload_count;
+        }
+    }
+
+#ifdef HAVE_THREADS
+    if (preload_lock) slock_lock(preload_lock); // Publish the finished image
+#endif
+    preload_done = 1;
+#ifdef HAVE_THREADS
+    if (preload_lock) slock_unlock(preload_lock);
+#endif
+}
+
+#ifdef HAVE_THREADS
+static void preload_worker(void *arg) {
+    (void)arg;
+    preload_run();
+}
+
+/* While the worker is reading, the emulation thread shares the backend with
+   it. Once the image is complete, the dispatch is switched to memory readers
+   here, on the emulation thread, so the pointers never change under a caller.
+*/
+static int preload_wait_read_sector(uint32_t lba, uint8_t *buf) {
+    int ret = 0;
+
+    slock_lock(preload_lock);
+    int done = preload_done;
+    if (!done)
+        ret = be_read_sector(lba, buf);
+    slock_unlock(preload_lock);
+
+    if (done) {
+        fn_read_sector = preload_read_sector;
+        fn_read_audio = preload_read_audio;
+        fn_sector_ptr = preload_sector_ptr;
+        return preload_read_sector(lba, buf);
+    }
+
+    return ret;
+}
+
+static int preload_wait_read_audio(uint32_t lba, int16_t *buf) {
+    int ret = 0;
+
+    slock_lock(preload_lock);
+    int done = preload_done;
+    if (!done)
+        ret = be_read_audio(lba, buf);
+    slock_unlock(preload_lock);
+
+    if (done) {
+        fn_read_sector = preload_read_sector;
+        fn_read_audio = preload_read_audio;
+        fn_sector_ptr = preload_sector_ptr;
+        return preload_read_audio(lba, buf);
+    }
+
+    return ret;
+}
+#endif
+
+static void preload_stop(void) {
+    preload_quit = 1;
+
+#ifdef HAVE_THREADS
+    if (preload_thread) {
+        sthread_join(preload_thread);
+        preload_thread = NULL;
+    }
+
+    if (preload_lock) {
+        slock_free(preload_lock);
+        preload_lock = NULL;
+    }
+#endif
+
+    if (preload_image) {
+        free(preload_image);
+        preload_image = NULL;
+    }
+
+    preload_ntracks = 0;
+    preload_total = preload_count = 0;
+    preload_done = 0;
+}
+
+static void preload_start(void) {
+    size_t size = 0;
+
+    preload_ntracks = 0;
+    for (unsigned i = 0; i < index_count; ++i) {
+        preload_track_t *t = &preload_tracks[preload_ntracks++];
+        t->start = disc_index[i].start;
+        t->frames = disc_index[i].frames;
+        t->audio = disc_index[i].audio;
+        t->offset = size;
+        size += (size_t)t->frames *
+            (t->audio ? GEO_DISC_SECTOR_SIZE : GEO_DISC_DATA_SIZE);
+        preload_total += t->frames;
+    }
+
+    preload_image = size ? (uint8_t*)malloc(size) : NULL;
+    if (!preload_image) {
+        geo_log(GEO_LOG_WRN, "Unable to allocate %zu bytes for disc preload\n",
+            size);
+        preload_ntracks = preload_total = 0;
+        return;
+    }
+
+    geo_log(GEO_LOG_INF, "Preloading disc: %u sectors, %zu bytes\n",
+        preload_total, size);
+
+    be_read_sector = fn_read_sector;
+    be_read_audio = fn_read_audio;
+    be_sector_ptr = fn_sector_ptr;
+    preload_quit = 0;
+
+#ifdef HAVE_THREADS
+    preload_lock = slock_new();
+    if (preload_lock) {
+        // Direct pointers are withheld until the image is complete
+        fn_read_sector = preload_wait_read_sector;
+        fn_read_audio = preload_wait_read_audio;
+        fn_sector_ptr = stub_sector_ptr;
+        preload_thread = sthread_create(preload_worker, NULL);
+        if (preload_thread)
+            return;
+
+        // Restore the backend readers and load synchronously instead
+        fn_read_sector = be_read_sector;
+        fn_read_audio = be_read_audio;
+        fn_sector_ptr = be_sector_ptr;
+        slock_free(preload_lock);
+        preload_lock = NULL;
+    }
+#endif
+
+    preload_run();
+    if (preload_done) {
+        fn_read_sector = preload_read_sector;
+        fn_read_audio = preload_read_audio;
+        fn_sector_ptr = preload_sector_ptr;
+    }
+}
+
+#ifdef HAVE_THREADS
+static int stage_read_sector(uint32_t lba, uint8_t *buf) {
+    slock_lock(stage_io_lock);
+    int ret = st_read_sector(lba, buf);
+    slock_unlock(stage_io_lock);
+    return ret;
+}
+
+static int stage_read_audio(uint32_t lba, int16_t *buf) {
+    slock_lock(stage_io_lock);
+    int ret = st_read_audio(lba, buf);
+    slock_unlock(stage_io_lock);
+    return ret;
+}
+
+// Fill in the header the LC8951 writes ahead of the user data
+static void stage_header(uint8_t *frame, uint32_t lba) {
+    uint8_t m, s, f;
+    geo_disc_lba_to_msf(lba + 150, &m, &s, &f);
+    frame[0] = ((m / 10) << 4) | (m % 10);
+    frame[1] = ((s / 10) << 4) | (s % 10);
+    frame[2] = ((f / 10) << 4) | (f % 10);
+    frame[3] = 0x01; // Mode 1
+}
+
+// Whether an LBA is a data sector the worker may read ahead
+static int stage_wanted(uint32_t lba) {
+    if (lba - stage_base >= GEO_DISC_STAGE_SECTORS || lba >= index_leadout)
+        return 0;
+
+    unsigned track = geo_disc_lookup_track(lba);
+    return !disc_index[track - 1].audio;
+}
+
+static void stage_worker(void *arg) {
+    (void)arg;
+
+    slock_lock(stage_lock);
+    while (!stage_quit) {
+        if (!stage_wanted(stage_next)) {
+            scond_wait(stage_cond, stage_lock);
+            continue;
+        }
+
+        uint32_t lba = stage_next++;
+        uint32_t gen = stage_gen;
+        stage_slot_t *slot = &stage_slots[lba % GEO_DISC_STAGE_SECTORS];
+        slock_unlock(stage_lock);
+
+        stage_header(slot->frame, lba);
+        slock_lock(stage_io_lock);
+        int ok = st_read_sector(lba, slot->frame + 4);
+        slock_unlock(stage_io_lock);
+
+        slock_lock(stage_lock);
+        if (ok && gen == stage_gen) {
+            slot->lba = lba;
+            slot->valid = 1;
+        }
+    }
+    slock_unlock(stage_lock);
+}
+
+static void stage_stop(void) {
+    if (stage_thread) {
+        slock_lock(stage_lock);
+        stage_quit = 1;
+        scond_signal(stage_cond);
+        slock_unlock(stage_lock);
+        sthread_join(stage_thread);
+        stage_thread = NULL;
+    }
+
+    if (stage_cond) {
+        scond_free(stage_cond);
+        stage_cond = NULL;
+    }
+
+    if (stage_io_lock) {
+        slock_free(stage_io_lock);
+        stage_io_lock = NULL;
+    }
+
+    if (stage_lock) {
+        slock_free(stage_lock);
+        stage_lock = NULL;
+    }
+}
+
+/* Bring the worker up on the first staged read. The backend readers are
+   wrapped here, on the emulation thread, so they never change under a caller.
+*/
+static int stage_start(void) {
+    stage_lock = slock_new();
+    stage_io_lock = slock_new();
+    stage_cond = scond_new();
+
+    if (stage_lock && stage_io_lock && stage_cond) {
+        for (unsigned i = 0; i < GEO_DISC_STAGE_SECTORS; ++i)
+            stage_slots[i].valid = 0;
+        stage_base = stage_next = 0;
+        stage_quit = 0;
+
+        st_read_sector = fn_read_sector;
+        st_read_audio = fn_read_audio;
+        fn_read_sector = stage_read_sector;
+        fn_read_audio = stage_read_audio;
+
+        stage_thread = sthread_create(stage_worker, NULL);
+        if (stage_thread)
+            return 1;
+
+        fn_read_sector = st_read_sector;
+        fn_read_audio = st_read_audio;
+    }
+
+    stage_stop();
+    stage_failed = 1;
+    geo_log(GEO_LOG_WRN, "Unable to start sector staging thread\n");
+    return 0;
+}
+#else
+static void stage_stop(void) {
+}
+#endif
+
 int geo_disc_open(const char *path) {
     int ok = 0;
     int backend = detect_backend(path);
@@ -121,6 +577,8 @@ int geo_disc_open(const char *path) {
             if (ok) {
                 fn_read_sector = geo_chd_read_sector;
                 fn_read_audio = geo_chd_read_audio;
+                fn_read_audio_sync = geo_chd_read_audio;
+                fn_sector_ptr = stub_sector_ptr;
                 fn_num_tracks = geo_chd_num_tracks;
                 fn_track_is_audio = geo_chd_track_is_audio;
                 fn_track_start = geo_chd_track_start;
@@ -134,6 +592,8 @@ int geo_disc_open(const char *path) {
             if (ok) {
                 fn_read_sector = geo_cue_read_sector;
                 fn_read_audio = geo_cue_read_audio;
+                fn_read_audio_sync = geo_cue_read_audio_sync;
+                fn_sector_ptr = geo_cue_sector_ptr;
                 fn_num_tracks = geo_cue_num_tracks;
                 fn_track_is_audio = geo_cue_track_is_audio;
                 fn_track_start = geo_cue_track_start;
@@ -152,6 +612,8 @@ int geo_disc_open(const char *path) {
     if (ok) {
         fn_read_sector = geo_cue_read_sector;
         fn_read_audio = geo_cue_read_audio;
+        fn_read_audio_sync = geo_cue_read_audio_sync;
+        fn_sector_ptr = geo_cue_sector_ptr;
         fn_num_tracks = geo_cue_num_tracks;
         fn_track_is_audio = geo_cue_track_is_audio;
         fn_track_start = geo_cue_track_start;
@@ -164,6 +626,8 @@ int geo_disc_open(const char *path) {
     if (!ok) { // Set stubs so callers don't need NULL checks
         fn_read_sector = stub_read;
         fn_read_audio = stub_read_audio;
+        fn_read_audio_sync = stub_read_audio;
+        fn_sector_ptr = stub_sector_ptr;
         fn_num_tracks = stub_num_tracks;
         fn_track_is_audio = stub_track_is_audio;
         fn_track_start = stub_track_u32;
@@ -171,14 +635,77 @@ int geo_disc_open(const char *path) {
         fn_leadout = stub_leadout;
         fn_close = NULL;
     }
+    else {
+        index_build();
+        if (preload_enabled)
+            preload_start();
+    }
 
     return ok;
 }
 
 void geo_disc_close(void) {
+    // Stop reading before the backend goes away
+    stage_stop();
+    preload_stop();
     if (fn_close)
         fn_close();
     clear_dispatch();
+    index_count = 0;
+    index_leadout = 0;
+    index_last = 0;
+#ifdef HAVE_THREADS
+    stage_failed = 0;
+#endif
+}
+
+// Find the index entry of the last track whose start is at or before an LBA
+static unsigned index_search(uint32_t disc_lba) {
+    unsigned lo = 0, hi = index_count - 1;
+    while (lo < hi) {
+        unsigned mid = (lo + hi + 1) >> 1;
+        if (disc_index[mid].start <= disc_lba)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    return lo;
+}
+
+unsigned geo_disc_find_track(uint32_t disc_lba) {
+    if (!index_count)
+        return 1;
+
+    unsigned last = index_last;
+    if (last < index_count && disc_lba >= disc_index[last].start &&
+        disc_lba < disc_index[last].end) {
+        return last + 1;
+    }
+
+    index_last = index_search(disc_lba);
+    return index_last + 1;
+}
+
+unsigned geo_disc_lookup_track(uint32_t disc_lba) {
+    return index_count ? index_search(disc_lba) + 1 : 1;
+}
+
+void geo_disc_set_index_dir(const char *dir) {
+#ifdef HAVE_CHDR
+    geo_chd_set_index_dir(dir);
+#else
+    (void)dir;
+#endif
+}
+
+void geo_disc_set_preload(int enabled) {
+    preload_enabled = enabled;
+}
+
+int geo_disc_preload_progress(void) {
+    if (!preload_total)
+        return -1;
+    return preload_done ? 100 : (int)(preload_count * 100ULL / preload_total);
 }
 
 int geo_disc_read_sector(uint32_t disc_lba, uint8_t *buf) {
@@ -189,24 +716,67 @@ int geo_disc_read_audio(uint32_t disc_lba, int16_t *buf) {
     return fn_read_audio(disc_lba, buf);
 }
 
+const uint8_t* geo_disc_sector_ptr(uint32_t disc_lba) {
+    return fn_sector_ptr(disc_lba);
+}
+
+const uint8_t* geo_disc_sector_frame(uint32_t disc_lba) {
+#ifdef HAVE_THREADS
+    if (preload_enabled || !index_count)
+        return NULL;
+
+    if (!stage_thread && (stage_failed || !stage_start()))
+        return NULL;
+
+    const uint8_t *frame = NULL;
+
+    slock_lock(stage_lock);
+    stage_slot_t *slot = &stage_slots[disc_lba % GEO_DISC_STAGE_SECTORS];
+    if (slot->valid && slot->lba == disc_lba) {
+        frame = slot->frame;
+        stage_base = disc_lba;
+    }
+    else { // Seek - restart the queue after this sector
+        ++stage_gen;
+        for (unsigned i = 0; i < GEO_DISC_STAGE_SECTORS; ++i)
+            stage_slots[i].valid = 0;
+        stage_base = disc_lba;
+        stage_next = disc_lba + 1;
+    }
+    scond_signal(stage_cond);
+    slock_unlock(stage_lock);
+
+    return frame;
+#else
+    (void)disc_lba;
+    return NULL;
+#endif
+}
+
 unsigned geo_disc_num_tracks(void) {
-    return fn_num_tracks();
+    return index_count;
 }
 
 int geo_disc_track_is_audio(unsigned track) {
-    return fn_track_is_audio(track);
+    if (track == 0 || track > index_count)
+        return 0;
+    return disc_index[track - 1].audio;
 }
 
 uint32_t geo_disc_track_start(unsigned track) {
-    return fn_track_start(track);
+    if (track == 0 || track > index_count)
+        return 0;
+    return disc_index[track - 1].start;
 }
 
 uint32_t geo_disc_track_frames(unsigned track) {
-    return fn_track_frames(track);
+    if (track == 0 || track > index_count)
+        return 0;
+    return disc_index[track - 1].frames;
 }
 
 uint32_t geo_disc_leadout(void) {
-    return fn_leadout();
+    return index_leadout;
 }
 
 void geo_disc_lba_to_msf(uint32_t lba, uint8_t *m, uint8_t *s, uint8_t *f) {
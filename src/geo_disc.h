@@ -34,6 +34,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define GEO_DISC_MAX_TRACKS  99
 #define GEO_DISC_SECTOR_SIZE 2352
 #define GEO_DISC_DATA_SIZE   2048
+#define GEO_DISC_FRAME_SIZE  (GEO_DISC_DATA_SIZE + 4) // Header + user data
+
+#define GEO_DISC_STAGE_SECTORS 16 // Data sectors staged ahead of the drive
 
 #define GEO_DISC_TRACK_DATA  0
 #define GEO_DISC_TRACK_AUDIO 1
@@ -41,9 +44,51 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 int geo_disc_open(const char *path);
 void geo_disc_close(void);
 
+/* Read the whole disc into memory when it is opened. With thread support the
+   image is filled in the background and reads switch to memory once it is
+   complete; otherwise the open blocks until the image is loaded. Takes effect
+   on the next open.
+*/
+void geo_disc_set_preload(int enabled);
+
+/* Directory in which to cache track indexes for images whose layout is costly
+   to parse (CHD metadata), or NULL to disable. Takes effect on the next open.
+*/
+void geo_disc_set_index_dir(const char *dir);
+
+// Preload progress as a percentage, or -1 if no preload is active
+int geo_disc_preload_progress(void);
+
 int geo_disc_read_sector(uint32_t disc_lba, uint8_t *buf);
 int geo_disc_read_audio(uint32_t disc_lba, int16_t *buf);
 
+/* Return a pointer to the 2048 bytes of user data for a sector when the
+   backend holds it in memory (mapped BIN/ISO files, a preloaded disc), or
+   NULL if the sector must be read with geo_disc_read_sector. The pointer is
+   only valid until the next disc operation.
+*/
+const uint8_t* geo_disc_sector_ptr(uint32_t disc_lba);
+
+/* Return a data sector framed as the LC8951 stores it - the 4 byte header
+   followed by the user data - if it was staged ahead of time by the read
+   ahead thread, or NULL otherwise. Each call consumes the sector and moves
+   the read ahead window past it, so a NULL return should be followed by a
+   geo_disc_read_sector call. The pointer is valid until the next call.
+*/
+const uint8_t* geo_disc_sector_frame(uint32_t disc_lba);
+
+/* Return the 1-based track containing an LBA, from the index built when the
+   disc was opened. LBAs before the first track belong to it. Call only from
+   the emulation thread, as it remembers the last hit to speed up the next.
+*/
+unsigned geo_disc_find_track(uint32_t disc_lba);
+
+/* The same lookup without the remembered hit, safe from any thread. Backends
+   use this for their own lookups once open, since their readers may run on
+   the read ahead or preload threads.
+*/
+unsigned geo_disc_lookup_track(uint32_t disc_lba);
+
 unsigned geo_disc_num_tracks(void);
 int geo_disc_track_is_audio(unsigned track);
 uint32_t geo_disc_track_start(unsigned track);
@@ -0,0 +1,215 @@
+/*
+Copyright (c) 2026 Rupert Carmichael
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* State hashing for desync detection
+
+   Memory is split into fixed size blocks, each with a cached 64-bit hash.
+   Write paths mark the blocks they touch as dirty, so producing a digest only
+   rehashes memory which has changed since the last call. The YM2610 state is
+   small enough to be serialized and hashed in full each time.
+
+   Digests are computed over memory in host byte order, so they are only
+   comparable between hosts of the same endianness. Anything writing to
+   emulated memory behind the core's back (cheats, memory map pokes from the
+   frontend) must call geo_hash_invalidate.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <common/xxhash.h>
+
+#include "geo.h"
+#include "geo_cd.h"
+#include "geo_hash.h"
+#include "geo_serial.h"
+#include "geo_ymfm.h"
+
+#define HASH_BLKSHIFT   12
+#define HASH_BLKSIZE    (1 << HASH_BLKSHIFT)
+
+// Enough blocks to cover the largest configuration (CD mode)
+#define HASH_BLKS_MAX \
+    ((SIZE_64K + SIZE_4K + SIZE_16K + SIZE_2M + SIZE_64K + SIZE_4M + SIZE_1M + \
+    SIZE_128K + SIZE_8K) >> HASH_BLKSHIFT)
+
+typedef struct _hash_area_t {
+    const uint8_t *mem;
+    size_t size;
+    size_t first; // Index of the area's first block in the block tables
+    size_t nblks;
+    unsigned subsys;
+} hash_area_t;
+
+static hash_area_t areas[GEO_HASH_AREA_MAX];
+static uint64_t blkhash[HASH_BLKS_MAX];
+static uint8_t dirty[HASH_BLKS_MAX];
+static size_t nblks_total = 0;
+static unsigned configured = 0;
+
+static uint8_t ymstate[SIZE_4K];
+
+static void geo_hash_area_set(unsigned area, const void *mem, size_t size,
+    unsigned subsys) {
+
+    areas[area].mem = (const uint8_t*)mem;
+    areas[area].size = mem ? size : 0;
+    areas[area].first = nblks_total;
+    areas[area].nblks = (areas[area].size + HASH_BLKSIZE - 1) >> HASH_BLKSHIFT;
+    areas[area].subsys = subsys;
+    nblks_total += areas[area].nblks;
+}
+
+// Fetch pointers to the memory areas in use and mark every block dirty
+static void geo_hash_configure(void) {
+    size_t sz = 0;
+    const void *ptr = NULL;
+
+    memset(areas, 0, sizeof(areas));
+    nblks_total = 0;
+
+    ptr = geo_mem_ptr(GEO_MEMTYPE_VRAM, &sz);
+    geo_hash_area_set(GEO_HASH_AREA_VRAM, ptr, sz, GEO_HASH_VRAM);
+
+    ptr = geo_mem_ptr(GEO_MEMTYPE_PALRAM, &sz);
+    geo_hash_area_set(GEO_HASH_AREA_PALRAM, ptr, sz, GEO_HASH_PALRAM);
+
+    ptr = geo_mem_ptr(GEO_MEMTYPE_MAINRAM, &sz);
+    geo_hash_area_set(GEO_HASH_AREA_MAINRAM, ptr, sz, GEO_HASH_MAINRAM);
+
+    if (ngsys.cdmode) {
+        // The CD system's RAM areas stand in for the cartridge ROMs
+        romdata_t *romdata = geo_romdata_ptr();
+        geo_hash_area_set(GEO_HASH_AREA_Z80RAM, romdata->m, romdata->msz,
+            GEO_HASH_Z80RAM);
+        geo_hash_area_set(GEO_HASH_AREA_SPRDRAM, geo_cd_sprdram_ptr(),
+            romdata->csz, GEO_HASH_CDRAM);
+        geo_hash_area_set(GEO_HASH_AREA_PCMDRAM, romdata->v1, romdata->v1sz,
+            GEO_HASH_CDRAM);
+        geo_hash_area_set(GEO_HASH_AREA_FIXRAM, romdata->s, romdata->ssz,
+            GEO_HASH_CDRAM);
+        geo_hash_area_set(GEO_HASH_AREA_BRAM, geo_cd_bram_ptr(), SIZE_8K,
+            GEO_HASH_CDRAM);
+    }
+    else {
+        ptr = geo_mem_ptr(GEO_MEMTYPE_Z80RAM, &sz);
+        geo_hash_area_set(GEO_HASH_AREA_Z80RAM, ptr, sz, GEO_HASH_Z80RAM);
+    }
+
+    memset(dirty, 1, nblks_total);
+    configured = 1;
+}
+
+// Mark the block containing an address within a memory area as dirty
+void geo_hash_dirty(unsigned area, size_t addr) {
+    if (addr < areas[area].size)
+        dirty[areas[area].first + (addr >> HASH_BLKSHIFT)] = 1;
+}
+
+// Mark all blocks overlapping a range of addresses within an area as dirty
+void geo_hash_dirty_range(unsigned area, size_t addr, size_t len) {
+    if (!len || addr >= areas[area].size)
+        return;
+
+    if (len > areas[area].size - addr)
+        len = areas[area].size - addr;
+
+    size_t first = areas[area].first + (addr >> HASH_BLKSHIFT);
+    size_t last = areas[area].first + ((addr + len - 1) >> HASH_BLKSHIFT);
+    memset(&dirty[first], 1, last - first + 1);
+}
+
+/* Force every block to be rehashed on the next call, after a reset, state
+   load, or a change of system type
+*/
+void geo_hash_invalidate(void) {
+    configured = 0;
+}
+
+void geo_state_hash(geo_hash_t *hash) {
+    uint64_t digest[GEO_HASH_AREA_MAX];
+    uint64_t subdigest[GEO_HASH_AREA_MAX];
+
+    if (!configured)
+        geo_hash_configure();
+
+    memset(hash, 0, sizeof(*hash));
+
+    // Rehash dirty blocks and produce a digest for each area
+    for (unsigned a = 0; a < GEO_HASH_AREA_MAX; ++a) {
+        hash_area_t *area = &areas[a];
+        digest[a] = 0;
+
+        if (!area->nblks)
+            continue;
+
+        for (size_t i = 0; i < area->nblks; ++i) {
+            size_t blk = area->first + i;
+            if (!dirty[blk])
+                continue;
+
+            size_t offset = i << HASH_BLKSHIFT;
+            size_t len = area->size - offset;
+            if (len > HASH_BLKSIZE)
+                len = HASH_BLKSIZE;
+
+            blkhash[blk] = XXH64(area->mem + offset, len, 0);
+            dirty[blk] = 0;
+        }
+
+        digest[a] = XXH64(&blkhash[area->first], area->nblks * sizeof(uint64_t),
+            a);
+    }
+
+    // Combine area digests into per-subsystem digests
+    for (unsigned s = 0; s < GEO_HASH_MAX; ++s) {
+        size_t n = 0;
+
+        if (s == GEO_HASH_YM2610)
+            continue;
+
+        for (unsigned a = 0; a < GEO_HASH_AREA_MAX; ++a) {
+            if (areas[a].nblks && areas[a].subsys == s)
+                subdigest[n++] = digest[a];
+        }
+
+        if (n)
+            hash->subsys[s] = XXH64(subdigest, n * sizeof(uint64_t), s);
+    }
+
+    // The YM2610 state is a few hundred bytes, so hash a serialized copy
+    geo_serial_begin();
+    geo_ymfm_state_save(ymstate);
+    hash->subsys[GEO_HASH_YM2610] =
+        XXH64(ymstate, geo_serial_size() - 1, GEO_HASH_YM2610);
+
+    hash->combined = XXH64(hash->subsys, sizeof(hash->subsys), 0);
+}
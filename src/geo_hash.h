@@ -0,0 +1,69 @@
+/*
+Copyright (c) 2026 Rupert Carmichael
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef GEO_HASH_H
+#define GEO_HASH_H
+
+// Subsystems which receive an individual digest
+enum geo_hash_subsys {
+    GEO_HASH_VRAM,
+    GEO_HASH_PALRAM,
+    GEO_HASH_MAINRAM,
+    GEO_HASH_Z80RAM,
+    GEO_HASH_YM2610,
+    GEO_HASH_CDRAM,
+    GEO_HASH_MAX
+};
+
+// Memory areas tracked for writes - CD RAM is split across several areas
+enum geo_hash_area {
+    GEO_HASH_AREA_VRAM,
+    GEO_HASH_AREA_PALRAM,
+    GEO_HASH_AREA_MAINRAM,
+    GEO_HASH_AREA_Z80RAM,
+    GEO_HASH_AREA_SPRDRAM,
+    GEO_HASH_AREA_PCMDRAM,
+    GEO_HASH_AREA_FIXRAM,
+    GEO_HASH_AREA_BRAM,
+    GEO_HASH_AREA_MAX
+};
+
+typedef struct _geo_hash_t {
+    uint64_t combined; // Digest of all subsystem digests
+    uint64_t subsys[GEO_HASH_MAX]; // Zero for subsystems not present
+} geo_hash_t;
+
+void geo_hash_dirty(unsigned, size_t);
+void geo_hash_dirty_range(unsigned, size_t, size_t);
+void geo_hash_invalidate(void);
+
+void geo_state_hash(geo_hash_t*);
+
+#endif
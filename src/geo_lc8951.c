@@ -65,9 +65,10 @@ static void lc_buffer_write(lc8951_t* const lc, size_t pos,
    first check, and also converts the BEQ instruction to a BNE to pass
    the second check.
 */
-static int protection_bypass(uint8_t *sector) {
+static int protection_bypass(lc8951_t* const lc, const uint8_t *sector,
+    uint16_t pos) {
     if (sector[64] == 'g' && !memcmp(sector, "Copyright by SNK", 16)) {
-        sector[64] = 'f';
+        lc->buffer[(uint16_t)(pos + 64)] = 'f';
         return 1;
     }
     return 0;
@@ -77,23 +78,42 @@ void geo_lc8951_sector_decoded(lc8951_t* const lc, uint32_t lba) {
     if (!lc->decoder_enabled)
         return;
 
-    // Update header with current MSF position
-    uint8_t m, s, f;
-    geo_disc_lba_to_msf(lba + 150, &m, &s, &f);
-    lc->head[0] = to_bcd(m);
-    lc->head[1] = to_bcd(s);
-    lc->head[2] = to_bcd(f);
-    lc->head[3] = 0x01; // Mode 1
-
     // Write 4-byte header + 2048-byte sector data into circular buffer at WAL
     // BIOS protocol: reads PTL, sets DAC = PTL + 4 (skip header), DBC = 0x7FF
-    lc_buffer_write(lc, lc->wal, lc->head, 4);
+    uint16_t pos = lc->wal + 4;
+    uint8_t sectorbuf[GEO_DISC_DATA_SIZE];
+    const uint8_t *sector = geo_disc_sector_ptr(lba);
+    const uint8_t *frame = sector ? NULL : geo_disc_sector_frame(lba);
+
+    if (frame) {
+        // Staged ahead of time with its header, so this is a single copy
+        memcpy(lc->head, frame, 4);
+        lc_buffer_write(lc, lc->wal, frame, GEO_DISC_FRAME_SIZE);
+        sector = frame + 4;
+    }
+    else {
+        // Update header with current MSF position
+        uint8_t m, s, f;
+        geo_disc_lba_to_msf(lba + 150, &m, &s, &f);
+        lc->head[0] = to_bcd(m);
+        lc->head[1] = to_bcd(s);
+        lc->head[2] = to_bcd(f);
+        lc->head[3] = 0x01; // Mode 1
+        lc_buffer_write(lc, lc->wal, lc->head, 4);
+
+        /* Copy straight from the backend's memory when it has the sector
+           mapped or preloaded, otherwise read it into a temporary buffer
+        */
+        if (!sector) {
+            geo_disc_read_sector(lba, sectorbuf);
+            sector = sectorbuf;
+        }
+        lc_buffer_write(lc, pos, sector, GEO_DISC_DATA_SIZE);
+    }
 
-    uint8_t sector[GEO_DISC_DATA_SIZE];
-    geo_disc_read_sector(lba, sector);
+    // Patch the copy in the buffer, never the source
     if (!lc->protection_bypassed)
-        lc->protection_bypassed = protection_bypass(sector);
-    lc_buffer_write(lc, (uint16_t)(lc->wal + 4), sector, GEO_DISC_DATA_SIZE);
+        lc->protection_bypassed = protection_bypass(lc, sector, pos);
 
     // PTL = WAL (snapshot before advancing — tells BIOS where sector starts)
     lc->ptl = lc->wal;
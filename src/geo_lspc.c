@@ -33,6 +33,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "geo.h"
 #include "geo_cd.h"
+#include "geo_hash.h"
 #include "geo_m68k.h"
 #include "geo_lspc.h"
 #include "geo_serial.h"
@@ -424,13 +425,49 @@ void geo_lspc_palram_wr08(uint32_t addr, uint8_t data) {
 
     unsigned idx = (addr & 0x0fff) + (lspc.palbank * SIZE_4K);
     geo_lspc_palconv(idx, lspc.palram[idx]);
+    geo_hash_dirty(GEO_HASH_AREA_PALRAM, idx << 1);
 }
 
 // Write a value to the active bank of palette RAM
 void geo_lspc_palram_wr16(uint32_t addr, uint16_t data) {
     addr >>= 1; // The address should access 16-bit values rather than bytes
-    lspc.palram[(addr & 0x0fff) + (lspc.palbank * SIZE_4K)] = data;
-    geo_lspc_palconv((addr & 0x0fff) + (lspc.palbank * SIZE_4K), data);
+    unsigned idx = (addr & 0x0fff) + (lspc.palbank * SIZE_4K);
+    lspc.palram[idx] = data;
+    geo_lspc_palconv(idx, data);
+    geo_hash_dirty(GEO_HASH_AREA_PALRAM, idx << 1);
+}
+
+/* Write a run of values to the active bank of palette RAM, as a DMA transfer
+   does. The values are stored first and converted afterwards in one pass,
+   wrapping within the bank like individual writes.
+*/
+void geo_lspc_palram_wr_block(uint32_t addr, const uint16_t *data, size_t n) {
+    unsigned bank = lspc.palbank * SIZE_4K;
+    unsigned first = (addr >> 1) & 0x0fff;
+
+    if (n > SIZE_4K) { // Only the last pass over the bank survives
+        data += n - SIZE_4K;
+        first = (first + (n - SIZE_4K)) & 0x0fff;
+        n = SIZE_4K;
+    }
+
+    for (size_t i = 0; i < n; ++i)
+        lspc.palram[bank + ((first + i) & 0x0fff)] = data[i];
+
+    for (size_t i = 0; i < n; ++i) {
+        unsigned idx = bank + ((first + i) & 0x0fff);
+        geo_lspc_palconv(idx, lspc.palram[idx]);
+    }
+
+    if (first + n <= SIZE_4K) {
+        geo_hash_dirty_range(GEO_HASH_AREA_PALRAM, (bank + first) << 1, n << 1);
+    }
+    else {
+        geo_hash_dirty_range(GEO_HASH_AREA_PALRAM, (bank + first) << 1,
+            (SIZE_4K - first) << 1);
+        geo_hash_dirty_range(GEO_HASH_AREA_PALRAM, bank << 1,
+            (n - (SIZE_4K - first)) << 1);
+    }
 }
 
 // Set the active palette bank
@@ -452,8 +489,10 @@ uint16_t geo_lspc_vram_rd(void) {
 // Write to VRAM
 void geo_lspc_vram_wr(uint16_t data) {
     // Writing beyond the boundary is not a winning endeavour
-    if (lspc.vramaddr < 0x8800)
+    if (lspc.vramaddr < 0x8800) {
         lspc.vram[lspc.vramaddr] = data; // Perform the write
+        geo_hash_dirty(GEO_HASH_AREA_VRAM, lspc.vramaddr << 1);
+    }
 
     // Apply the modulo after the write, wrapping within the correct bank
     lspc.vramaddr = ((lspc.vramaddr + lspc.vrammod) & 0x7fff) | lspc.vrambank;
@@ -753,6 +792,10 @@ static inline unsigned geo_lspc_tpix(unsigned tbase, unsigned x, unsigned y) {
        interleaved every byte, the second byte is in the third position, and
        the third byte is in the second position.
 
+       Neo Geo CD Sprite DRAM stores the bytes in the order [1, 0, 3, 2], but
+       the CD system keeps a copy converted to C ROM order, so both systems
+       share this path.
+
        Notes: Since there are 4 bytes per row of pixels, multiply the tile's
               base address by 4 to select the specific row in the tile.
               The pixel data is stored right to left -- this means it is in
@@ -760,19 +803,10 @@ static inline unsigned geo_lspc_tpix(unsigned tbase, unsigned x, unsigned y) {
               is enabled for the tile.
     */
     unsigned base = tbase + (y << 2);
-    unsigned v0, v1, v2, v3;
-    if (ngsys.cdmode) { // CD SPR DRAM: Non-interleaved byte order [1, 0, 3, 2]
-        v0 = (romdata->c[base + 1]) >> (x);
-        v1 = (romdata->c[base + 0]) >> (x);
-        v2 = (romdata->c[base + 3]) >> (x);
-        v3 = (romdata->c[base + 2]) >> (x);
-    }
-    else { // Cart C ROM: Interleaved odd/even byte order [0, 2, 1, 3]
-        v0 = (romdata->c[base + 0]) >> (x);
-        v1 = (romdata->c[base + 2]) >> (x);
-        v2 = (romdata->c[base + 1]) >> (x);
-        v3 = (romdata->c[base + 3]) >> (x);
-    }
+    unsigned v0 = (romdata->c[base + 0]) >> (x);
+    unsigned v1 = (romdata->c[base + 2]) >> (x);
+    unsigned v2 = (romdata->c[base + 1]) >> (x);
+    unsigned v3 = (romdata->c[base + 3]) >> (x);
     return (v0 & 0x01) | (v1 & 0x01) << 1 | (v2 & 0x01) << 2 | (v3 & 0x01) << 3;
 }
 
@@ -105,6 +105,7 @@ uint8_t geo_lspc_palram_rd08(uint32_t);
 uint16_t geo_lspc_palram_rd16(uint32_t);
 void geo_lspc_palram_wr08(uint32_t, uint8_t);
 void geo_lspc_palram_wr16(uint32_t, uint16_t);
+void geo_lspc_palram_wr_block(uint32_t, const uint16_t*, size_t);
 void geo_lspc_palram_bank(unsigned);
 
 void geo_lspc_vramaddr_wr(uint16_t);
@@ -36,6 +36,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "geo.h"
 #include "geo_cd.h"
+#include "geo_hash.h"
 #include "geo_lspc.h"
 #include "geo_m68k.h"
 #include "geo_rtc.h"
@@ -987,6 +988,7 @@ static void geo_m68k_cart_write_8(unsigned address, unsigned value) {
     else if (address < 0x200000) { // RAM - Mirrored every 64K
         m68k_modify_timeslice(1);
         write08(ram, address & 0xffff, value & 0xff);
+        geo_hash_dirty(GEO_HASH_AREA_MAINRAM, address & 0xffff);
     }
     else if (address < 0x300000) { // Switchable 1M Program ROM Bank
         m68k_modify_timeslice(1);
@@ -1164,6 +1166,7 @@ static void geo_m68k_cart_write_16(unsigned address, unsigned value) {
     else if (address < 0x200000) { // RAM - Mirrored every 64K
         m68k_modify_timeslice(1);
         write16(ram, address & 0xffff, value & 0xffff);
+        geo_hash_dirty(GEO_HASH_AREA_MAINRAM, address & 0xffff);
     }
     else if (address < 0x300000) { // Switchable 1M Program ROM Bank
         m68k_modify_timeslice(1);
@@ -1482,7 +1485,7 @@ uint8_t geo_m68k_reg_poutput(void) {
     return reg_poutput;
 }
 
-void geo_m68k_state_load(uint8_t *st) {
+void geo_m68k_state_load(uint8_t *st, unsigned ver) {
     m68k_set_reg(M68K_REG_D0, geo_serial_pop32(st));
     m68k_set_reg(M68K_REG_D1, geo_serial_pop32(st));
     m68k_set_reg(M68K_REG_D2, geo_serial_pop32(st));
@@ -1514,6 +1517,11 @@ void geo_m68k_state_load(uint8_t *st) {
     m68ki_cpu.virq_state = geo_serial_pop32(st);
     m68ki_cpu.nmi_pending = geo_serial_pop32(st);
 
+    if (ver >= 0x03) { // Earlier states relied on the reset before loading
+        m68ki_cpu.stopped = geo_serial_pop32(st);
+        m68ki_cpu.reset_cycles = geo_serial_pop32(st);
+    }
+
     geo_serial_popblk(ram, st, SIZE_64K);
     cartreg[0] = geo_serial_pop16(st);
     cartreg[1] = geo_serial_pop16(st);
@@ -1569,6 +1577,8 @@ void geo_m68k_state_save(uint8_t *st) {
     geo_serial_push32(st, m68ki_cpu.int_level);
     geo_serial_push32(st, m68ki_cpu.virq_state);
     geo_serial_push32(st, m68ki_cpu.nmi_pending);
+    geo_serial_push32(st, m68ki_cpu.stopped);
+    geo_serial_push32(st, m68ki_cpu.reset_cycles);
 
     geo_serial_pushblk(st, ram, SIZE_64K);
     geo_serial_push16(st, cartreg[0]);
@@ -80,7 +80,7 @@ void geo_m68k_postload(void);
 
 uint8_t geo_m68k_reg_poutput(void);
 
-void geo_m68k_state_load(uint8_t*);
+void geo_m68k_state_load(uint8_t*, unsigned);
 void geo_m68k_state_save(uint8_t*);
 
 const void* geo_m68k_ram_ptr(void);
@@ -28,23 +28,53 @@ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <math.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
-#include <speex/speex_resampler.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
 
 #include "geo.h"
 #include "geo_cd.h"
 #include "geo_mixer.h"
 #include "geo_ymfm.h"
 
-/* MVS samplerate is 55555Hz, AES samplerate is 55943.489Hz, but adjustments
-   are needed to ensure clean resampling. Slight adjustments for accuracy may
-   be done by a frontend with its own resampler, using the precise video
-   framerate.
-     samplerate * (60 / framerate) = ~56319.437
+/* The YM2610 runs from the same crystal as the rest of the system, so it
+   generates the same number of samples every frame on the AES and MVS, and its
+   exact rate follows from the framerate:
+     405504 master cycles per frame / (6 * 72) = ~938.667 samples per frame
+     938.667 * 59.185606Hz = ~55555Hz (MVS), 938.667 * 59.599484 = ~55943Hz (AES)
+   Resampling by this ratio produces exactly samplerate / framerate samples per
+   frame on average, with the fraction carried from one frame to the next.
 */
-#define SAMPLERATE_YM2610 56319
+#define YM2610_SAMPS_PER_FRAME (405504.0 / 432.0)
+
+/* Polyphase windowed sinc resampler. The filter for each of RESAMP_PHASES
+   fractional positions is precomputed. Decimating by more than 1:1 (high
+   fidelity YM2610 output) widens the filter in proportion to the ratio.
+*/
+#define RESAMP_PHASE_BITS 10
+#define RESAMP_PHASES (1 << RESAMP_PHASE_BITS)
+#define RESAMP_TAPS 40 // Taps per phase at a ratio of 1:1 or less
+#define RESAMP_BETA 7.0 // Kaiser window shape, ~70dB stopband
+#define RESAMP_CUTOFF 0.465 // Cutoff as a fraction of the lower sample rate
+#define RESAMP_CHUNK 4096 // Input samples buffered per pass
+#define RESAMP_PI 3.14159265358979323846
+
+/* Dynamic rate control: when the frontend reports how full its audio buffer
+   is, the resampling ratio is nudged to hold the buffer half full, producing
+   fewer samples when it is filling and more when it is draining. The change
+   is bounded, and slewed from frame to frame, to keep pitch shifts inaudible.
+*/
+#define DRC_TARGET 50 // Target buffer occupancy, percent
+#define DRC_MAX 0.005 // Largest ratio adjustment
+#define DRC_SLEW 0.0001 // Largest change to the adjustment per frame
 
 void (*geo_mixer_output)(size_t);
 
@@ -53,33 +83,223 @@ static int16_t cddabuf[2048]; // Sufficiently sized for a frame of stereo audio
 static size_t samplerate = 44100; // Default sample rate is 44100Hz
 static double framerate = FRAMERATE_AES; // Default to AES
 
-static SpeexResamplerState *resampler = NULL;
-static int err;
+static int16_t *coefs = NULL; // RESAMP_PHASES filters of 'taps' coefficients
+static unsigned taps = 0;
+static int16_t *hist[2] = { NULL, NULL }; // Left/Right input history
+static size_t histlen = 0; // Input samples in the history
+static uint64_t step = 0; // Input samples per output sample, 32.32
+static uint64_t pos = 0; // Position of the next output in the history, 32.32
+static uint64_t stepadj = 0; // Step with rate control applied, 32.32
+static int fill = -1; // Frontend buffer occupancy in percent, -1 if unknown
+static double drc = 0.0; // Current ratio adjustment
 
 // Callback to notify the fronted that N samples are ready
 static void (*geo_mixer_cb)(size_t);
 
+// Add src into dst, saturating to the int16_t range
+static void geo_mixer_add_sat(int16_t *dst, const int16_t *src, size_t n) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 8 <= n; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_adds_epi16(a, b));
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    for (; i + 8 <= n; i += 8)
+        vst1q_s16(dst + i, vqaddq_s16(vld1q_s16(dst + i), vld1q_s16(src + i)));
+#endif
+    for (; i < n; ++i) {
+        int32_t sum = (int32_t)dst[i] + (int32_t)src[i];
+        if (sum > 32767)
+            sum = 32767;
+        else if (sum < -32768)
+            sum = -32768;
+        dst[i] = (int16_t)sum;
+    }
+}
+
+// Dot product of n samples and coefficients, n being a multiple of 8
+static inline int32_t geo_mixer_dot(const int16_t *a, const int16_t *b,
+    unsigned n) {
+#if defined(__SSE2__)
+    __m128i acc = _mm_setzero_si128();
+    for (unsigned i = 0; i < n; i += 8) {
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(
+            _mm_loadu_si128((const __m128i*)(a + i)),
+            _mm_loadu_si128((const __m128i*)(b + i))));
+    }
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0x4e));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0xb1));
+    return _mm_cvtsi128_si32(acc);
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    int32x4_t acc = vdupq_n_s32(0);
+    for (unsigned i = 0; i < n; i += 8) {
+        acc = vmlal_s16(acc, vld1_s16(a + i), vld1_s16(b + i));
+        acc = vmlal_s16(acc, vld1_s16(a + i + 4), vld1_s16(b + i + 4));
+    }
+    int32x2_t sum = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+    return vget_lane_s32(vpadd_s32(sum, sum), 0);
+#else
+    int32_t acc = 0;
+    for (unsigned i = 0; i < n; ++i)
+        acc += a[i] * b[i];
+    return acc;
+#endif
+}
+
+// Scale a Q15 filter output back to a sample, saturating to the int16_t range
+static inline int16_t geo_mixer_sat(int32_t acc) {
+    acc = (acc + (1 << 14)) >> 15;
+    return acc > 32767 ? 32767 : acc < -32768 ? -32768 : acc;
+}
+
+// Zeroth order modified Bessel function of the first kind, for the window
+static double geo_mixer_i0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 32; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+// Build the filter tables for a given input to output ratio
+static int geo_mixer_resamp_init(double ratio) {
+    // Widen the filter and lower the cutoff when decimating
+    double scale = ratio > 1.0 ? ratio : 1.0;
+    double cutoff = RESAMP_CUTOFF / (2.0 * scale); // Cycles per input sample
+    taps = ((unsigned)ceil(RESAMP_TAPS * scale) + 7) & ~7;
+
+    coefs = (int16_t*)malloc(RESAMP_PHASES * taps * sizeof(int16_t));
+    hist[0] = (int16_t*)calloc(taps + RESAMP_CHUNK, sizeof(int16_t));
+    hist[1] = (int16_t*)calloc(taps + RESAMP_CHUNK, sizeof(int16_t));
+    if (!coefs || !hist[0] || !hist[1])
+        return 0;
+
+    double *h = (double*)malloc(taps * sizeof(double));
+    if (!h)
+        return 0;
+
+    double half = taps / 2.0;
+    double i0beta = geo_mixer_i0(RESAMP_BETA);
+
+    for (unsigned p = 0; p < RESAMP_PHASES; ++p) {
+        /* Tap j is the input sample j - (taps / 2 - 1) away from the integer
+           part of the output position, and the output lies a fraction p of
+           the way to the next input sample.
+        */
+        double frac = (double)p / RESAMP_PHASES;
+        double sum = 0.0;
+        for (unsigned j = 0; j < taps; ++j) {
+            double t = j - (half - 1.0) - frac;
+            double x = t / half;
+            double w = x * x < 1.0 ?
+                geo_mixer_i0(RESAMP_BETA * sqrt(1.0 - x * x)) / i0beta : 0.0;
+            double sinc = t == 0.0 ? 1.0 :
+                sin(2.0 * RESAMP_PI * cutoff * t) / (2.0 * RESAMP_PI * cutoff * t);
+            h[j] = w * sinc;
+            sum += h[j];
+        }
+
+        // Normalize for unity gain, putting the rounding error on the peak
+        int16_t *c = &coefs[p * taps];
+        int32_t total = 0;
+        unsigned peak = 0;
+        for (unsigned j = 0; j < taps; ++j) {
+            c[j] = (int16_t)lrint(h[j] / sum * 32768.0);
+            total += c[j];
+            if (c[j] > c[peak])
+                peak = j;
+        }
+        c[peak] += 32768 - total;
+    }
+
+    free(h);
+
+    step = stepadj = (uint64_t)llrint(ratio * 4294967296.0);
+    drc = 0.0;
+    pos = 0;
+    histlen = 0;
+    return 1;
+}
+
+// Resample interleaved stereo input, returning the number of output samples
+static size_t geo_mixer_resamp_run(const int16_t *in, size_t insamps,
+    int16_t *out) {
+    size_t outsamps = 0;
+
+    while (insamps) {
+        // Deinterleave as much input as fits behind the history
+        size_t n = taps + RESAMP_CHUNK - histlen;
+        if (n > insamps)
+            n = insamps;
+
+        for (size_t i = 0; i < n; ++i) {
+            hist[0][histlen + i] = in[i << 1];
+            hist[1][histlen + i] = in[(i << 1) + 1];
+        }
+        histlen += n;
+        in += n << 1;
+        insamps -= n;
+
+        // Generate every output whose filter is covered by the history
+        for (size_t i = pos >> 32; i + taps <= histlen; i = pos >> 32) {
+            const int16_t *c = &coefs[((pos >> (32 - RESAMP_PHASE_BITS)) &
+                (RESAMP_PHASES - 1)) * taps];
+            out[outsamps << 1] =
+                geo_mixer_sat(geo_mixer_dot(&hist[0][i], c, taps));
+            out[(outsamps << 1) + 1] =
+                geo_mixer_sat(geo_mixer_dot(&hist[1][i], c, taps));
+            ++outsamps;
+            pos += stepadj;
+        }
+
+        // Drop input which no future output needs
+        size_t used = pos >> 32;
+        if (used > histlen)
+            used = histlen;
+        memmove(hist[0], &hist[0][used], (histlen - used) * sizeof(int16_t));
+        memmove(hist[1], &hist[1][used], (histlen - used) * sizeof(int16_t));
+        histlen -= used;
+        pos -= (uint64_t)used << 32;
+    }
+
+    return outsamps;
+}
+
+/* Move the ratio adjustment towards the one wanted for the buffer occupancy.
+   Called once per frame, as the slew is a per frame limit however many
+   chunks the frame's audio is output in.
+*/
+void geo_mixer_frame_end(void) {
+    double target = fill < 0 ? 0.0 :
+        DRC_MAX * (fill - DRC_TARGET) / (100 - DRC_TARGET);
+
+    if (target > DRC_MAX)
+        target = DRC_MAX;
+    else if (target < -DRC_MAX)
+        target = -DRC_MAX;
+
+    if (target > drc + DRC_SLEW)
+        drc += DRC_SLEW;
+    else if (target < drc - DRC_SLEW)
+        drc -= DRC_SLEW;
+    else
+        drc = target;
+
+    stepadj = (uint64_t)llrint(step * (1.0 + drc));
+}
+
 // Resample audio and pass the samples back to the frontend
 static void geo_mixer_resamp(size_t in_ym) {
     int16_t *ybuf = geo_ymfm_get_buffer();
-    spx_uint32_t insamps = in_ym;
-    spx_uint32_t outsamps = samplerate / framerate;
-
-    err = speex_resampler_process_interleaved_int(resampler,
-        (spx_int16_t*)ybuf, &insamps, (spx_int16_t*)abuf, &outsamps);
+    size_t outsamps = coefs ? geo_mixer_resamp_run(ybuf, in_ym, abuf) : 0;
 
     if (ngsys.cdmode) {
         // Read equal number of samples generated by the YM2610 from the CD
-        geo_cd_read_cdda(cddabuf, outsamps);
-        for (size_t i = 0; i < outsamps << 1; ++i) {
-            // Sum and clamp
-            int32_t sum = (int32_t)abuf[i] + (int32_t)cddabuf[i];
-            if (sum > 32767)
-                sum = 32767;
-            else if (sum < -32768)
-                sum = -32768;
-            abuf[i] = (int16_t)sum;
-        }
+        if (geo_cd_read_cdda(cddabuf, outsamps))
+            geo_mixer_add_sat(abuf, cddabuf, outsamps << 1);
     }
 
     geo_mixer_cb(outsamps << 1);
@@ -111,6 +331,13 @@ void geo_mixer_set_rate(size_t rate) {
     samplerate = rate;
 }
 
+/* Set the frontend audio buffer occupancy in percent, or -1 if it is unknown,
+   to steer the resampling ratio
+*/
+void geo_mixer_set_fill(int f) {
+    fill = f;
+}
+
 // Set output to raw samples
 void geo_mixer_set_raw(int raw) {
     geo_mixer_output = raw ? &geo_mixer_raw : &geo_mixer_resamp;
@@ -118,19 +345,27 @@ void geo_mixer_set_raw(int raw) {
 
 // Deinitialize the resampler
 void geo_mixer_deinit(void) {
-    if (resampler) {
-        speex_resampler_destroy(resampler);
-        resampler = NULL;
-    }
+    free(coefs);
+    free(hist[0]);
+    free(hist[1]);
+    coefs = hist[0] = hist[1] = NULL;
 }
 
-// Bring up the Speex resampler
+// Bring up the resampler
 void geo_mixer_init(void) {
     if (ngsys.sys == SYSTEM_MVS || ngsys.sys == SYSTEM_UNI)
         framerate = FRAMERATE_MVS;
     else
         framerate = FRAMERATE_AES;
 
-    resampler = speex_resampler_init(2, SAMPLERATE_YM2610, samplerate, 3, &err);
+    double inrate =
+        YM2610_SAMPS_PER_FRAME * geo_ymfm_oversample() * framerate;
+
+    geo_mixer_deinit();
+    if (!geo_mixer_resamp_init(inrate / samplerate)) {
+        geo_log(GEO_LOG_ERR, "Failed to allocate resampler\n");
+        geo_mixer_deinit();
+    }
+
     geo_mixer_output = &geo_mixer_resamp;
 }
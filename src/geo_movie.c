@@ -0,0 +1,611 @@
+/*
+Copyright (c) 2026 Rupert Carmichael
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Input Movie File Format (all values big endian)
+ * =====================================================================
+ * | Offset | Size | Description                                       |
+ * =====================================================================
+ * |   0x00 |    4 | Signature: 'G' 'E' 'O' 'M'                        |
+ * |   0x04 |    1 | Version                                           |
+ * |   0x05 |    1 | System                                            |
+ * |   0x06 |    1 | Region                                            |
+ * |   0x07 |    1 | CD mode                                           |
+ * |   0x08 |    4 | Length in frames                                  |
+ * |   0x0c |    4 | Keyframe interval                                 |
+ * |   0x10 |    4 | Number of keyframes                               |
+ * |   0x14 |    4 | Uncompressed state size                           |
+ * |   0x18 |    4 | Input log size                                    |
+ * ---------------------------------------------------------------------
+ *
+ * Each keyframe follows the header: frame number (4), input log offset (4),
+ * input values in effect (7), compressed state size (4), then the deflate
+ * compressed state. Keyframe 0 is the starting state. The input log follows
+ * the keyframes.
+ *
+ * The input log holds one record per frame: flags (1), number of changes
+ * (4), then for each change the index of the input read within the frame
+ * (4), the input source (1), and the new value (1). Only reads returning a
+ * different value to the previous read of the same source are stored, which
+ * is enough to reproduce every read since playback makes the same reads in
+ * the same order.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <miniz.h>
+
+#include "geo.h"
+#include "geo_lspc.h"
+#include "geo_movie.h"
+#include "geo_vfs.h"
+#include "geo_ymfm.h"
+
+#define MOVIE_VERSION       0x01
+#define MOVIE_SIZE_HEADER   28
+#define MOVIE_SIZE_FRAMEHDR 5
+#define MOVIE_SIZE_CHANGE   6
+
+// Input sources: joystick ports followed by system status callbacks
+#define MOVIE_SOURCES       (NUMINPUTS_NG + NUMINPUTS_SYS)
+
+#define MOVIE_FLAG_RESET    0x01
+#define MOVIE_FLAG_HARD     0x02
+
+typedef struct _movie_keyframe_t {
+    uint32_t frame; // Frame the state was taken at the start of
+    uint32_t logpos; // Offset of that frame's record in the input log
+    uint8_t last[MOVIE_SOURCES]; // Input values in effect
+    uint8_t *data; // Compressed state
+    size_t size;
+} movie_keyframe_t;
+
+static unsigned mode = GEO_MOVIE_IDLE;
+static unsigned interval = GEO_MOVIE_KEYFRAME_INTERVAL;
+static uint8_t moviesys = 0;
+static uint8_t movieregion = 0;
+static uint8_t moviecd = 0;
+
+static uint32_t frame = 0; // Current frame
+static uint32_t nframes = 0; // Length of the movie in frames
+static size_t statesz = 0;
+
+// Input log
+static uint8_t *inlog = NULL;
+static size_t logsz = 0;
+static size_t logcap = 0;
+static size_t logpos = 0; // Start of the current frame's record
+
+// Keyframes
+static movie_keyframe_t *keyframes = NULL;
+static size_t nkeyframes = 0;
+static size_t keyframecap = 0;
+
+// Per-frame input tracking
+static uint8_t last[MOVIE_SOURCES];
+static uint32_t readidx = 0;
+static uint32_t nchanges = 0;
+static uint32_t chgidx = 0;
+static uint8_t flags = 0;
+static uint8_t pending_flags = 0;
+static unsigned desync = 0;
+
+// Input callbacks installed by the frontend, restored when the movie stops
+static unsigned (*orig_cb[NUMINPUTS_NG])(unsigned);
+static unsigned (*orig_sys_cb[NUMINPUTS_SYS])(void);
+
+static inline void write32be(uint8_t *ptr, uint32_t v) {
+    ptr[0] = v >> 24;
+    ptr[1] = (v >> 16) & 0xff;
+    ptr[2] = (v >> 8) & 0xff;
+    ptr[3] = v & 0xff;
+}
+
+static inline uint32_t read32be(const uint8_t *ptr) {
+    return ((uint32_t)ptr[0] << 24) | (ptr[1] << 16) | (ptr[2] << 8) | ptr[3];
+}
+
+// Make room for len more bytes in the input log
+static int geo_movie_log_reserve(size_t len) {
+    if (logsz + len <= logcap)
+        return 1;
+
+    size_t newcap = logcap ? logcap : SIZE_64K;
+    while (newcap < logsz + len)
+        newcap <<= 1;
+
+    uint8_t *newlog = (uint8_t*)realloc(inlog, newcap);
+    if (!newlog)
+        return 0;
+
+    inlog = newlog;
+    logcap = newcap;
+    return 1;
+}
+
+static void geo_movie_free(void) {
+    for (size_t i = 0; i < nkeyframes; ++i)
+        free(keyframes[i].data);
+
+    free(keyframes);
+    keyframes = NULL;
+    nkeyframes = keyframecap = 0;
+
+    free(inlog);
+    inlog = NULL;
+    logsz = logcap = logpos = 0;
+
+    frame = nframes = 0;
+}
+
+// Record, or play back, a single read of an input source
+static unsigned geo_movie_input(unsigned src, unsigned val) {
+    if (mode == GEO_MOVIE_RECORD) {
+        val &= 0xff;
+        if (val != last[src]) {
+            if (!geo_movie_log_reserve(MOVIE_SIZE_CHANGE)) {
+                geo_log(GEO_LOG_ERR, "Movie input log allocation failed\n");
+                geo_movie_stop();
+                return val;
+            }
+            write32be(inlog + logsz, readidx);
+            inlog[logsz + 4] = src;
+            inlog[logsz + 5] = val;
+            logsz += MOVIE_SIZE_CHANGE;
+            last[src] = val;
+            ++nchanges;
+        }
+    }
+    else if (chgidx < nchanges) {
+        const uint8_t *chg = inlog + logpos + MOVIE_SIZE_FRAMEHDR +
+            (chgidx * MOVIE_SIZE_CHANGE);
+
+        if (read32be(chg) == readidx) {
+            if (chg[4] != src && !desync) {
+                geo_log(GEO_LOG_WRN, "Movie desync at frame %u\n", frame);
+                desync = 1;
+            }
+            last[chg[4] % MOVIE_SOURCES] = chg[5];
+            ++chgidx;
+        }
+    }
+
+    ++readidx;
+    return last[src];
+}
+
+static unsigned geo_movie_input_cb(unsigned port) {
+    return geo_movie_input(port,
+        mode == GEO_MOVIE_RECORD ? orig_cb[port](port) : 0);
+}
+
+static unsigned geo_movie_input_sys(unsigned n) {
+    return geo_movie_input(NUMINPUTS_NG + n,
+        mode == GEO_MOVIE_RECORD ? orig_sys_cb[n]() : 0);
+}
+
+static unsigned geo_movie_input_sys0(void) { return geo_movie_input_sys(0); }
+static unsigned geo_movie_input_sys1(void) { return geo_movie_input_sys(1); }
+static unsigned geo_movie_input_sys2(void) { return geo_movie_input_sys(2); }
+static unsigned geo_movie_input_sys3(void) { return geo_movie_input_sys(3); }
+static unsigned geo_movie_input_sys4(void) { return geo_movie_input_sys(4); }
+
+static unsigned (*movie_sys_cb[NUMINPUTS_SYS])(void) = {
+    geo_movie_input_sys0, geo_movie_input_sys1, geo_movie_input_sys2,
+    geo_movie_input_sys3, geo_movie_input_sys4
+};
+
+// Route input through the movie, remembering the frontend's callbacks
+static void geo_movie_hook_input(void) {
+    for (unsigned i = 0; i < NUMINPUTS_NG; ++i) {
+        orig_cb[i] = geo_input_cb[i];
+        geo_input_cb[i] = &geo_movie_input_cb;
+    }
+
+    for (unsigned i = 0; i < NUMINPUTS_SYS; ++i) {
+        orig_sys_cb[i] = geo_input_sys_cb[i];
+        geo_input_sys_cb[i] = movie_sys_cb[i];
+    }
+}
+
+static void geo_movie_unhook_input(void) {
+    for (unsigned i = 0; i < NUMINPUTS_NG; ++i)
+        geo_input_cb[i] = orig_cb[i];
+
+    for (unsigned i = 0; i < NUMINPUTS_SYS; ++i)
+        geo_input_sys_cb[i] = orig_sys_cb[i];
+}
+
+// Take a compressed keyframe state at the start of the current frame
+static int geo_movie_keyframe(void) {
+    if (nkeyframes == keyframecap) {
+        size_t newcap = keyframecap ? keyframecap << 1 : 64;
+        movie_keyframe_t *newkf = (movie_keyframe_t*)realloc(keyframes,
+            newcap * sizeof(movie_keyframe_t));
+        if (!newkf)
+            return 0;
+        keyframes = newkf;
+        keyframecap = newcap;
+    }
+
+    const void *st = geo_state_save_raw();
+    mz_ulong compsz = mz_compressBound(statesz);
+    uint8_t *data = (uint8_t*)malloc(compsz);
+    if (!data)
+        return 0;
+
+    if (mz_compress2(data, &compsz, (const unsigned char*)st, statesz,
+        MZ_BEST_SPEED) != MZ_OK) {
+        free(data);
+        return 0;
+    }
+
+    // Shrink the allocation to the compressed size
+    uint8_t *shrunk = (uint8_t*)realloc(data, compsz);
+    if (shrunk)
+        data = shrunk;
+
+    movie_keyframe_t *kf = &keyframes[nkeyframes++];
+    kf->frame = frame;
+    kf->logpos = logsz;
+    memcpy(kf->last, last, sizeof(last));
+    kf->data = data;
+    kf->size = compsz;
+
+    return 1;
+}
+
+// Restore the machine and input log position from a keyframe
+static int geo_movie_keyframe_load(movie_keyframe_t *kf) {
+    uint8_t *st = (uint8_t*)malloc(statesz);
+    if (!st)
+        return 0;
+
+    mz_ulong sz = statesz;
+    if (mz_uncompress(st, &sz, kf->data, kf->size) != MZ_OK || sz != statesz ||
+        !geo_state_load_raw(st)) {
+        free(st);
+        return 0;
+    }
+
+    free(st);
+
+    frame = kf->frame;
+    logpos = kf->logpos;
+    memcpy(last, kf->last, sizeof(last));
+    return 1;
+}
+
+// Begin recording from the current state, with keyframes every n frames
+int geo_movie_record(unsigned n) {
+    geo_movie_stop();
+    geo_movie_free();
+
+    interval = n;
+    moviesys = ngsys.sys;
+    movieregion = ngsys.region;
+    moviecd = ngsys.cdmode;
+    statesz = geo_state_size();
+    memset(last, 0xff, sizeof(last));
+    pending_flags = 0;
+
+    if (!geo_movie_keyframe()) {
+        geo_log(GEO_LOG_ERR, "Movie starting state could not be saved\n");
+        return 0;
+    }
+
+    geo_movie_hook_input();
+    mode = GEO_MOVIE_RECORD;
+
+    return 1;
+}
+
+// Load a movie from a file and begin playback from its starting state
+int geo_movie_play(const char *filename) {
+    size_t sz = 0;
+    uint8_t *buf = (uint8_t*)geo_vfs_read_file(filename, &sz);
+    if (!buf)
+        return 0;
+
+    geo_movie_stop();
+    geo_movie_free();
+
+    if (sz < MOVIE_SIZE_HEADER || memcmp(buf, "GEOM", 4) ||
+        buf[4] != MOVIE_VERSION) {
+        geo_log(GEO_LOG_ERR, "Not a valid movie file\n");
+        free(buf);
+        return 0;
+    }
+
+    if (buf[5] != ngsys.sys || buf[6] != ngsys.region ||
+        buf[7] != ngsys.cdmode) {
+        geo_log(GEO_LOG_ERR, "Movie is for a different system type or "
+            "region\n");
+        free(buf);
+        return 0;
+    }
+
+    moviesys = buf[5];
+    movieregion = buf[6];
+    moviecd = buf[7];
+    nframes = read32be(buf + 8);
+    interval = read32be(buf + 12);
+    size_t nkf = read32be(buf + 16);
+    statesz = read32be(buf + 20);
+    size_t lsz = read32be(buf + 24);
+
+    if (statesz != geo_state_size() || !nkf) {
+        geo_log(GEO_LOG_ERR, "Movie state is incompatible\n");
+        free(buf);
+        return 0;
+    }
+
+    size_t pos = MOVIE_SIZE_HEADER;
+
+    keyframes = (movie_keyframe_t*)calloc(nkf, sizeof(movie_keyframe_t));
+    if (!keyframes)
+        goto fail;
+    keyframecap = nkf;
+
+    for (size_t i = 0; i < nkf; ++i) {
+        if (sz - pos < 8 + MOVIE_SOURCES + 4)
+            goto fail;
+
+        movie_keyframe_t *kf = &keyframes[i];
+        kf->frame = read32be(buf + pos);
+        kf->logpos = read32be(buf + pos + 4);
+        memcpy(kf->last, buf + pos + 8, MOVIE_SOURCES);
+        kf->size = read32be(buf + pos + 8 + MOVIE_SOURCES);
+        pos += 8 + MOVIE_SOURCES + 4;
+
+        if (sz - pos < kf->size || kf->logpos > lsz)
+            goto fail;
+
+        kf->data = (uint8_t*)malloc(kf->size);
+        if (!kf->data)
+            goto fail;
+
+        memcpy(kf->data, buf + pos, kf->size);
+        pos += kf->size;
+        ++nkeyframes;
+    }
+
+    if (sz - pos < lsz || !geo_movie_log_reserve(lsz))
+        goto fail;
+
+    memcpy(inlog, buf + pos, lsz);
+    logsz = lsz;
+    free(buf);
+
+    if (!geo_movie_keyframe_load(&keyframes[0])) {
+        geo_log(GEO_LOG_ERR, "Movie starting state could not be loaded\n");
+        geo_movie_free();
+        return 0;
+    }
+
+    desync = 0;
+    geo_movie_hook_input();
+    mode = GEO_MOVIE_PLAY;
+
+    return 1;
+
+fail:
+    geo_log(GEO_LOG_ERR, "Movie file is truncated or corrupt\n");
+    free(buf);
+    geo_movie_free();
+    return 0;
+}
+
+// Write the movie recorded or played back most recently to a file
+int geo_movie_save(const char *filename) {
+    uint8_t hdr[MOVIE_SIZE_HEADER];
+
+    if (!nkeyframes)
+        return 0;
+
+    void *file = geo_vfs_open(filename, GEO_VFS_WRITE);
+    if (!file)
+        return 0;
+
+    memcpy(hdr, "GEOM", 4);
+    hdr[4] = MOVIE_VERSION;
+    hdr[5] = moviesys;
+    hdr[6] = movieregion;
+    hdr[7] = moviecd;
+    write32be(hdr + 8, nframes);
+    write32be(hdr + 12, interval);
+    write32be(hdr + 16, nkeyframes);
+    write32be(hdr + 20, statesz);
+    write32be(hdr + 24, logsz);
+
+    int ret = geo_vfs_write(file, hdr, MOVIE_SIZE_HEADER) == MOVIE_SIZE_HEADER;
+
+    for (size_t i = 0; ret && i < nkeyframes; ++i) {
+        uint8_t kfhdr[8 + MOVIE_SOURCES + 4];
+        movie_keyframe_t *kf = &keyframes[i];
+        write32be(kfhdr, kf->frame);
+        write32be(kfhdr + 4, kf->logpos);
+        memcpy(kfhdr + 8, kf->last, MOVIE_SOURCES);
+        write32be(kfhdr + 8 + MOVIE_SOURCES, kf->size);
+
+        ret = geo_vfs_write(file, kfhdr, sizeof(kfhdr)) == sizeof(kfhdr) &&
+            geo_vfs_write(file, kf->data, kf->size) == (int64_t)kf->size;
+    }
+
+    if (ret && logsz)
+        ret = geo_vfs_write(file, inlog, logsz) == (int64_t)logsz;
+
+    geo_vfs_close(file);
+    return ret;
+}
+
+/* Seek to the start of a frame during playback by loading the nearest
+   preceding keyframe and running the remaining frames without rendering.
+   Sound generation is stopped for the run, so no audio reaches the frontend
+   from inside the seek.
+*/
+int geo_movie_seek(uint32_t target) {
+    if (mode != GEO_MOVIE_PLAY || target > nframes)
+        return 0;
+
+    // Binary search for the last keyframe at or before the target frame
+    size_t lo = 0, hi = nkeyframes;
+    while (hi - lo > 1) {
+        size_t mid = (lo + hi) >> 1;
+        if (keyframes[mid].frame <= target)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    if (!geo_movie_keyframe_load(&keyframes[lo]))
+        return 0;
+
+    desync = 0;
+
+    geo_lspc_set_skip_render(1);
+    geo_ymfm_set_silent(1);
+    while (frame < target && mode == GEO_MOVIE_PLAY)
+        geo_exec();
+    geo_ymfm_set_silent(0);
+    geo_lspc_set_skip_render(0);
+
+    return frame == target;
+}
+
+// Stop recording or playback, returning input to the frontend
+void geo_movie_stop(void) {
+    if (mode == GEO_MOVIE_IDLE)
+        return;
+
+    geo_movie_unhook_input();
+    mode = GEO_MOVIE_IDLE;
+}
+
+void geo_movie_deinit(void) {
+    geo_movie_stop();
+    geo_movie_free();
+}
+
+// Reset requested by the frontend
+void geo_movie_reset(int hard) {
+    if (mode == GEO_MOVIE_PLAY) // Resets come from the movie during playback
+        return;
+
+    if (mode == GEO_MOVIE_RECORD)
+        pending_flags = MOVIE_FLAG_RESET | (hard ? MOVIE_FLAG_HARD : 0);
+
+    geo_reset(hard);
+}
+
+unsigned geo_movie_mode(void) {
+    return mode;
+}
+
+uint32_t geo_movie_frame(void) {
+    return frame;
+}
+
+uint32_t geo_movie_length(void) {
+    return nframes;
+}
+
+// Called at the start of each emulated frame
+void geo_movie_frame_begin(void) {
+    if (mode == GEO_MOVIE_IDLE)
+        return;
+
+    readidx = 0;
+    chgidx = 0;
+
+    if (mode == GEO_MOVIE_RECORD) {
+        if (!geo_movie_log_reserve(MOVIE_SIZE_FRAMEHDR)) {
+            geo_log(GEO_LOG_ERR, "Movie input log allocation failed\n");
+            geo_movie_stop();
+            return;
+        }
+
+        // The number of changes is filled in when the frame ends
+        logpos = logsz;
+        inlog[logsz] = pending_flags;
+        logsz += MOVIE_SIZE_FRAMEHDR;
+        pending_flags = 0;
+        nchanges = 0;
+        return;
+    }
+
+    if (frame >= nframes) {
+        geo_log(GEO_LOG_INF, "Movie playback finished\n");
+        geo_movie_stop();
+        return;
+    }
+
+    // Validate the frame record before trusting it
+    if (logsz - logpos < MOVIE_SIZE_FRAMEHDR ||
+        (logsz - logpos - MOVIE_SIZE_FRAMEHDR) / MOVIE_SIZE_CHANGE <
+        read32be(inlog + logpos + 1)) {
+        geo_log(GEO_LOG_ERR, "Movie input log is corrupt at frame %u\n",
+            frame);
+        geo_movie_stop();
+        return;
+    }
+
+    flags = inlog[logpos];
+    nchanges = read32be(inlog + logpos + 1);
+
+    if (flags & MOVIE_FLAG_RESET)
+        geo_reset(flags & MOVIE_FLAG_HARD ? 1 : 0);
+}
+
+// Called at the end of each emulated frame
+void geo_movie_frame_end(void) {
+    if (mode == GEO_MOVIE_IDLE)
+        return;
+
+    if (mode == GEO_MOVIE_RECORD) {
+        write32be(inlog + logpos + 1, nchanges);
+        logpos = logsz;
+        nframes = ++frame;
+
+        if (interval && !(frame % interval) && !geo_movie_keyframe())
+            geo_log(GEO_LOG_WRN, "Movie keyframe at frame %u failed\n", frame);
+        return;
+    }
+
+    if (chgidx != nchanges && !desync) {
+        geo_log(GEO_LOG_WRN, "Movie desync at frame %u\n", frame);
+        desync = 1;
+    }
+
+    logpos += MOVIE_SIZE_FRAMEHDR + (nchanges * MOVIE_SIZE_CHANGE);
+    ++frame;
+}
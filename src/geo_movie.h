@@ -0,0 +1,69 @@
+/*
+Copyright (c) 2026 Rupert Carmichael
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef GEO_MOVIE_H
+#define GEO_MOVIE_H
+
+#define GEO_MOVIE_IDLE      0
+#define GEO_MOVIE_RECORD    1
+#define GEO_MOVIE_PLAY      2
+
+// Default spacing of keyframe states, in frames (~10 seconds)
+#define GEO_MOVIE_KEYFRAME_INTERVAL 600
+
+/* Input movies
+
+   A movie is a starting state followed by a log of every value returned by
+   the input callbacks, so any title using any input device plays back
+   exactly. Keyframe states are taken every interval frames so playback can
+   seek without replaying from the start.
+
+   Recording and playback take over the input callbacks, so they must be
+   started after the frontend has installed its own. Frontend initiated
+   resets must go through geo_movie_reset so they are captured. Loading a
+   state while recording produces a movie which will not play back.
+*/
+int geo_movie_record(unsigned);
+int geo_movie_play(const char*);
+int geo_movie_save(const char*);
+int geo_movie_seek(uint32_t);
+void geo_movie_stop(void);
+void geo_movie_deinit(void);
+
+void geo_movie_reset(int);
+
+unsigned geo_movie_mode(void);
+uint32_t geo_movie_frame(void);
+uint32_t geo_movie_length(void);
+
+void geo_movie_frame_begin(void);
+void geo_movie_frame_end(void);
+
+#endif
@@ -37,6 +37,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "geo_m68k.h"
 #include "geo_neo.h"
 #include "geo_sma.h"
+#include "geo_ymfm.h"
 #include "geo_z80.h"
 
 static uint32_t flags = 0;
@@ -123,6 +124,9 @@ int geo_neo_load(void *data, size_t size) {
 
     romdata->c = &neodata[rom_offset];
 
+    // Set up V ROM addressing for the ADPCM engines
+    geo_ymfm_postload();
+
     // Perform C ROM mask calculation
     geo_lspc_postload();
 
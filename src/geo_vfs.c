@@ -33,6 +33,14 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define GEO_VFS_MMAP
+#endif
+
 #include "geo_vfs.h"
 
 /* Built-in stdio implementation.
@@ -147,6 +155,9 @@ static const geo_vfs_t geo_vfs_stdio = {
 
 static const geo_vfs_t *vfs = &geo_vfs_stdio;
 
+// Memory mapping policy: -1 follows the installed operations, 0 or 1 forces
+static int map_mode = -1;
+
 void geo_vfs_set_callbacks(const geo_vfs_t *newvfs) {
     vfs = newvfs ? newvfs : &geo_vfs_stdio;
 }
@@ -220,3 +231,50 @@ void* geo_vfs_read_file(const char *path, size_t *size) {
 
     return (void*)buf;
 }
+
+void geo_vfs_set_map(int mode) {
+    map_mode = mode;
+}
+
+void* geo_vfs_map_file(const char *path, size_t *size) {
+#ifdef GEO_VFS_MMAP
+    if (!map_mode || (map_mode < 0 && vfs != &geo_vfs_stdio))
+        return NULL;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping holds its own reference to the file
+
+    if (data == MAP_FAILED)
+        return NULL;
+
+    if (size)
+        *size = (size_t)st.st_size;
+
+    return data;
+#else
+    (void)path;
+    (void)size;
+    return NULL;
+#endif
+}
+
+void geo_vfs_unmap_file(void *data, size_t size) {
+#ifdef GEO_VFS_MMAP
+    if (data)
+        munmap(data, size);
+#else
+    (void)data;
+    (void)size;
+#endif
+}
@@ -100,4 +100,23 @@ int     geo_vfs_resolve(char *out, size_t outsz, const char *base,
 */
 void* geo_vfs_read_file(const char *path, size_t *size);
 
+/* Map an entire file into memory as a private, writable view. Pages which
+   are only ever read are shared with the page cache, and therefore with any
+   other process mapping the same file; pages which are written are copied on
+   first write and stay private. This bypasses the installed file I/O
+   operations, so the path must be a plain filesystem path. Returns NULL on
+   failure, when mapping is disabled, or on platforms without memory mapping,
+   in which case the caller should fall back to the file I/O operations.
+   Release with geo_vfs_unmap_file.
+*/
+void* geo_vfs_map_file(const char *path, size_t *size);
+void  geo_vfs_unmap_file(void *data, size_t size);
+
+/* Control memory mapping. By default (-1) files are only mapped while the
+   built-in implementation is installed, since frontend operations may deal in
+   paths which are not plain filesystem paths. Frontends which know otherwise
+   can pass 1 to always attempt mapping, or 0 to never map.
+*/
+void geo_vfs_set_map(int mode);
+
 #endif
@@ -40,26 +40,40 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "geo_ymfm.h"
 #include "geo_z80.h"
 
-#define SIZE_YMBUF 2048
-#define DIVISOR 144 // 144 for medium fidelity, 16 for high
-
-static romdata_t *romdata = NULL;
+#define SIZE_YMBUF (2048 * 9) // A frame of stereo samples at high fidelity
+#define DIVISOR_MED 144 // Master clocks per sample at medium fidelity
 
 static int16_t ymbuf[SIZE_YMBUF];
 static size_t bufpos;
 static int32_t busytimer;
 static int32_t timer[2];
-static int32_t output[3];
+static int silent = 0; // Chip state only, no sound generation
+
+/* Output fidelity: minimum and medium are the same for the YM2610, with one
+   sample per 144 master clocks. Maximum runs at the SSG rate, one sample per
+   16 master clocks, so nine samples are generated for every medium one.
+*/
+static int fidelity = GEO_YMFM_FIDELITY_MED;
+static unsigned oversample = 1;
+static int32_t divisor = DIVISOR_MED;
+
+// Render cost counters, timed if the frontend provides a clock
+static geo_ymfm_stats_t stats;
+static int64_t (*geo_ymfm_clock)(void) = NULL;
 
+/* Sound is generated in blocks rather than one sample per call. Samples are
+   counted as the YM2610 is clocked and rendered when something could change
+   the output: register data writes, end of sample flag reads, timer expiry
+   (CSM key on), PCM DRAM writes on the CD system, and the end of the frame.
+   The result is identical to generating each sample as it is clocked.
+*/
+static int32_t blockbuf[(SIZE_YMBUF >> 1) * 3]; // FM L, FM R, SSG per sample
+static size_t pending = 0;
+
+// ADPCM sample memory is read directly by the engines, see geo_ymfm_postload
 uint8_t ymfm_external_read(uint32_t type, uint32_t address) {
-    switch (type) {
-        case ACCESS_ADPCM_A:
-            return address > romdata->v1sz ? 0 : romdata->v1[address];
-        case ACCESS_ADPCM_B:
-            return address > romdata->v2sz ? 0 : romdata->v2[address];
-        default:
-            return 0;
-    }
+    if (type || address) { }
+    return 0;
 }
 
 void ymfm_external_write(uint32_t type, uint32_t address, uint8_t data) {
@@ -91,9 +105,48 @@ void ymfm_update_irq(bool asserted) {
     asserted ? geo_z80_assert_irq(0) : geo_z80_clear_irq();
 }
 
+// Mix FM and SSG channels while maintaining a value within the int16_t range
+static inline int16_t mix(int32_t samp0, int32_t samp1) {
+    if (samp0 + samp1 >= 32767)
+        return 32767;
+    else if (samp0 + samp1 <= -32768)
+        return -32768;
+    return samp0 + samp1;
+}
+
+// Render samples which have been clocked but not yet generated
+void geo_ymfm_flush(void) {
+    if (!pending)
+        return;
+
+    if (silent) { // Keep the chip moving, but produce nothing to mix
+        ym2610_clock_block(pending);
+        pending = 0;
+        return;
+    }
+
+    int64_t start = geo_ymfm_clock ? geo_ymfm_clock() : 0;
+
+    ym2610_generate_block(blockbuf, pending);
+
+    // Mix stereo FM/ADPCM output (0,1) with mono SSG output (2)
+    const int32_t *b = blockbuf;
+    for (size_t i = 0; i < pending; ++i, b += 3) {
+        ymbuf[bufpos++] = mix(b[0], b[2]);
+        ymbuf[bufpos++] = mix(b[1], b[2]);
+    }
+
+    if (geo_ymfm_clock)
+        stats.usec += geo_ymfm_clock() - start;
+    stats.samples += pending;
+    ++stats.blocks;
+
+    pending = 0;
+}
+
 static inline void geo_ymfm_timer_tick(void) {
     if (busytimer > 0) {
-        busytimer -= DIVISOR;
+        busytimer -= divisor;
         if (busytimer < 0)
             busytimer = 0;
     }
@@ -101,14 +154,25 @@ static inline void geo_ymfm_timer_tick(void) {
     for (int i = 0; i < 2; ++i) {
         if (timer[i] < 0)
             continue;
-        timer[i] -= DIVISOR;
-        if (timer[i] <= 0)
+        timer[i] -= divisor;
+        if (timer[i] <= 0) {
+            geo_ymfm_flush();
             fm_engine_timer_expired(i);
+        }
     }
 }
 
+/* Sample memory is about to change (CD PCM DRAM): render what was clocked from
+   the old contents and drop ADPCM-A samples decoded from it
+*/
+void geo_ymfm_pcm_dirty(void) {
+    geo_ymfm_flush();
+    adpcm_a_cache_invalidate();
+}
+
 // Grab the pointer to the buffer
 int16_t* geo_ymfm_get_buffer(void) {
+    geo_ymfm_flush();
     bufpos = 0;
     return &ymbuf[0];
 }
@@ -116,47 +180,105 @@ int16_t* geo_ymfm_get_buffer(void) {
 // Initialize the YM2610
 void geo_ymfm_init(void) {
     ym2610_init();
-    ym2610_set_fidelity(OPN_FIDELITY_MED);
+    ym2610_set_fidelity(fidelity == GEO_YMFM_FIDELITY_MAX ?
+        OPN_FIDELITY_MAX : OPN_FIDELITY_MED);
     fm_engine_init();
-    romdata = geo_romdata_ptr();
+}
+
+// Release decoded ADPCM-A samples
+void geo_ymfm_deinit(void) {
+    adpcm_a_cache_invalidate();
+}
+
+/* Point the ADPCM engines at V ROM. It is read in place, so a NEO image mapped
+   from disk is never written to or copied.
+*/
+void geo_ymfm_postload(void) {
+    romdata_t *romdata = geo_romdata_ptr();
+    adpcm_a_set_rom(romdata->v1, romdata->v1sz);
+    adpcm_b_set_rom(romdata->v2, romdata->v2sz);
 }
 
 // Perform a reset - required at least once before clocking
 void geo_ymfm_reset(void) {
+    pending = 0;
     ym2610_reset();
 }
 
-// Mix FM and SSG channels while maintaining a value within the int16_t range
-static inline int16_t mix(int32_t samp0, int32_t samp1) {
-    if (samp0 + samp1 >= 32767)
-        return 32767;
-    else if (samp0 + samp1 <= -32768)
-        return -32768;
-    return samp0 + samp1;
-}
-
-// Clock the YM2610
+// Clock the YM2610 - the sample is generated with the next block
 size_t geo_ymfm_exec(void) {
     geo_ymfm_timer_tick();
-    ym2610_generate(output);
+    ++pending;
+    return !silent;
+}
 
-    // Mix stereo FM/ADPCM output (0,1) with mono SSG output (2)
-    ymbuf[bufpos++] = mix(output[0], output[2]);
-    ymbuf[bufpos++] = mix(output[1], output[2]);
+// Read from the YM2610
+uint8_t geo_ymfm_read(uint32_t port) {
+    if ((port & 3) == 2) // End of sample flags are set as samples are generated
+        geo_ymfm_flush();
+    return ym2610_read(port);
+}
+
+// Write to the YM2610
+void geo_ymfm_write(uint32_t port, uint8_t data) {
+    if (port & 1) // Data writes take effect from the next sample
+        geo_ymfm_flush();
+    ym2610_write(port, data);
+}
+
+/* Stop generating sound while the chip keeps running: the timers keep the Z80
+   sound driver receiving its interrupts, and FM envelopes, ADPCM playback and
+   the end of sample flags advance as usual. Only the output is dropped.
+*/
+void geo_ymfm_set_silent(int s) {
+    geo_ymfm_flush(); // Samples clocked so far belong to the old mode
+    silent = s;
+}
+
+// Set the output fidelity - must be called before geo_ymfm_init
+void geo_ymfm_set_fidelity(int f) {
+    fidelity = f;
+    oversample = f == GEO_YMFM_FIDELITY_MAX ? 9 : 1;
+    divisor = DIVISOR_MED / oversample;
+}
+
+// Number of samples generated in the time of one medium fidelity sample
+unsigned geo_ymfm_oversample(void) {
+    return oversample;
+}
+
+// Set a clock returning microseconds, used to time sound generation
+void geo_ymfm_set_clock(int64_t (*cb)(void)) {
+    geo_ymfm_clock = cb;
+}
+
+// Copy out the render cost counters and start counting again
+void geo_ymfm_get_stats(geo_ymfm_stats_t *s) {
+    uint32_t idle[YM2610_IDLE_ENGINES];
+    ym2610_get_idle(idle);
 
-    return 1;
+    *s = stats;
+    s->idle_fm = idle[YM2610_IDLE_FM];
+    s->idle_adpcma = idle[YM2610_IDLE_ADPCM_A];
+    s->idle_adpcmb = idle[YM2610_IDLE_ADPCM_B];
+    s->idle_ssg = idle[YM2610_IDLE_SSG];
+    stats.samples = 0;
+    stats.blocks = 0;
+    stats.usec = 0;
 }
 
 // Hacks
 void geo_ymfm_adpcm_wrap(int w) {
+    geo_ymfm_flush();
     adpcm_a_set_accum_wrap(w);
 }
 
 // States
 void geo_ymfm_state_load(uint8_t *st, unsigned ver) {
+    pending = 0;
     busytimer = geo_serial_pop32(st);
     if (ver == 0x00) {
-        busytimer *= DIVISOR; // Best effort
+        busytimer *= DIVISOR_MED; // Best effort
         geo_serial_pop32(st); // Empty, was busyfrac
     }
     timer[0] = geo_serial_pop32(st);
@@ -164,13 +286,17 @@ void geo_ymfm_state_load(uint8_t *st, unsigned ver) {
     opn_state_load(st);
     adpcm_state_load(st);
     ssg_state_load(st);
+    if (ver >= 0x03) // SSG output phase, missing from earlier states
+        ssg_resampler_state_load(st);
 }
 
 void geo_ymfm_state_save(uint8_t *st) {
+    geo_ymfm_flush();
     geo_serial_push32(st, busytimer);
     geo_serial_push32(st, timer[0]);
     geo_serial_push32(st, timer[1]);
     opn_state_save(st);
     adpcm_state_save(st);
     ssg_state_save(st);
+    ssg_resampler_state_save(st);
 }
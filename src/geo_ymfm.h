@@ -31,10 +31,37 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef GEO_YMFM_H
 #define GEO_YMFM_H
 
+enum geo_ymfm_fidelity {
+    GEO_YMFM_FIDELITY_MIN,
+    GEO_YMFM_FIDELITY_MED,
+    GEO_YMFM_FIDELITY_MAX
+};
+
+typedef struct _geo_ymfm_stats_t {
+    uint32_t samples; // Samples rendered
+    uint32_t blocks; // Calls to render a block of samples
+    int64_t usec; // Time spent rendering, if a clock is set
+    uint32_t idle_fm; // Samples skipped by each engine with nothing to do
+    uint32_t idle_adpcma;
+    uint32_t idle_adpcmb;
+    uint32_t idle_ssg;
+} geo_ymfm_stats_t;
+
 int16_t* geo_ymfm_get_buffer(void);
 void geo_ymfm_init(void);
+void geo_ymfm_deinit(void);
+void geo_ymfm_postload(void);
 void geo_ymfm_reset(void);
 size_t geo_ymfm_exec(void);
+void geo_ymfm_flush(void);
+void geo_ymfm_pcm_dirty(void);
+uint8_t geo_ymfm_read(uint32_t);
+void geo_ymfm_write(uint32_t, uint8_t);
+void geo_ymfm_set_silent(int);
+void geo_ymfm_set_fidelity(int);
+unsigned geo_ymfm_oversample(void);
+void geo_ymfm_set_clock(int64_t (*)(void));
+void geo_ymfm_get_stats(geo_ymfm_stats_t*);
 
 void geo_ymfm_adpcm_wrap(int);
 
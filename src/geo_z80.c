@@ -33,6 +33,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <stdint.h>
 
 #include "geo.h"
+#include "geo_hash.h"
+#include "geo_ymfm.h"
 #include "geo_z80.h"
 #include "geo_serial.h"
 #include "ymfm/ymfm_opn.h"
@@ -57,6 +59,7 @@ static uint8_t geo_z80_cd_mem_rd(void *userdata, uint16_t addr) {
 static void geo_z80_cd_mem_wr(void *userdata, uint16_t addr, uint8_t data) {
     (void)userdata;
     mrom[addr] = data;
+    geo_hash_dirty(GEO_HASH_AREA_Z80RAM, addr);
 }
 
 /* Z80 Memory Map
@@ -100,8 +103,10 @@ static uint8_t geo_z80_mem_rd(void *userdata, uint16_t addr) {
 static void geo_z80_mem_wr(void *userdata, uint16_t addr, uint8_t data) {
     if (userdata) { } // Unused
 
-    if (addr > 0xf7ff)
+    if (addr > 0xf7ff) {
         zram[addr & 0x07ff] = data;
+        geo_hash_dirty(GEO_HASH_AREA_Z80RAM, addr & 0x07ff);
+    }
     else
         geo_log(GEO_LOG_DBG, "Z80 write outside RAM: %04x %02x\n", addr, data);
 }
@@ -157,7 +162,7 @@ static uint8_t geo_z80_port_rd(z80 *userdata, uint16_t port) {
             return ngsys.sound_code;
         }
         case 0x04: case 0x05: case 0x06: case 0x07: {
-            return ym2610_read(port);
+            return geo_ymfm_read(port);
         }
         case 0x08: {
             geo_z80_bankswap(3, port);
@@ -204,7 +209,7 @@ static void geo_z80_port_wr(z80 *userdata, uint16_t port, uint8_t value) {
             break;
         }
         case 0x04: case 0x05: case 0x06: case 0x07: {
-            ym2610_write(port, value);
+            geo_ymfm_write(port, value);
             break;
         }
         case 0x08: case 0x09: case 0x0a: case 0x0b: {
@@ -233,6 +238,7 @@ static void geo_z80_port_wr(z80 *userdata, uint16_t port, uint8_t value) {
 // Reset the Z80
 void geo_z80_reset(void) {
     z80_reset(&z80ctx);
+    geo_ymfm_flush();
     ym2610_reset();
     nmi_enabled = 0;
 
@@ -297,6 +303,7 @@ void geo_z80_clear_irq(void) {
 void geo_z80_assert_reset(void) {
     // Halt the Z80, and also reset the YM2610
     z80ctx.halted = 1;
+    geo_ymfm_flush();
     ym2610_reset();
 }
 
@@ -31,6 +31,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "ymfm.h"
@@ -52,9 +53,38 @@ static uint8_t m_regdata_b[REGISTERS_B];         // register data
 static adpcm_a_channel m_channel_a[CHANNELS_A];  // array of channels
 static adpcm_b_channel m_channel_b;              // channel
 
+// ADPCM-A channels which are playing or have not yet returned to 0 output;
+// the others produce nothing and are neither clocked nor mixed
+static uint32_t m_active_a = 0;
+
+// sample memory, read directly rather than through ymfm_external_read;
+// reads at or past the end return 0
+static const uint8_t *m_rom_a = NULL;
+static uint32_t m_rom_a_size = 0;
+static const uint8_t *m_rom_b = NULL;
+static uint32_t m_rom_b_size = 0;
+
 // hacks
 static bool accum_wrap = true; // default to real hardware behaviour
 
+// ADPCM-A decoded sample cache
+#define CACHE_A_ENTRIES 128
+#define CACHE_A_BUDGET (8 * 1024 * 1024) // bytes of decoded samples
+#define CACHE_A_MINSIZE 4096 // nibbles allocated for a new entry
+
+typedef struct _adpcm_a_cache_entry
+{
+	uint32_t *data;                       // channel state after each nibble
+	uint32_t start;                       // start address register value
+	uint32_t len;                         // nibbles decoded
+	uint32_t size;                        // nibbles allocated
+	uint32_t used;                        // last key on, for LRU eviction
+} adpcm_a_cache_entry;
+
+static adpcm_a_cache_entry m_cache_a[CACHE_A_ENTRIES];
+static uint32_t m_cache_a_bytes;              // bytes allocated
+static uint32_t m_cache_a_stamp;              // key on counter
+
 //*********************************************************
 // ADPCM "A" REGISTERS
 //*********************************************************
@@ -150,6 +180,8 @@ static inline void adpcm_a_channel_init(uint32_t choffs)
 	m_channel_a[choffs].m_curaddress = 0;
 	m_channel_a[choffs].m_accumulator = 0;
 	m_channel_a[choffs].m_step_index = 0;
+	m_channel_a[choffs].m_cache = -1;
+	m_channel_a[choffs].m_cachepos = 0;
 }
 
 //-------------------------------------------------
@@ -164,6 +196,171 @@ static inline void adpcm_a_channel_reset(uint32_t choffs)
 	m_channel_a[choffs].m_curaddress = 0;
 	m_channel_a[choffs].m_accumulator = 0;
 	m_channel_a[choffs].m_step_index = 0;
+	m_channel_a[choffs].m_cache = -1;
+	m_channel_a[choffs].m_cachepos = 0;
+}
+
+
+//*********************************************************
+// ADPCM "A" DECODED SAMPLE CACHE
+//*********************************************************
+//
+// A channel always starts decoding at its start address
+// with the accumulator and step index at zero, so the
+// channel state after each nibble depends only on the
+// start address and the sample memory. Channels record
+// their state per nibble as they decode, and later key
+// ons of the same start address replay it instead of
+// decoding again. End addresses are still checked as
+// each byte is reached, so samples can end at any point
+// of a cached run.
+//
+// Each state is packed as the current byte (31-24), the
+// step index (17-12), and the 12-bit accumulator (11-0).
+//
+
+//-------------------------------------------------
+//  cache_evict - free an entry, detaching any
+//  channels still playing from it
+//-------------------------------------------------
+
+static void adpcm_a_cache_evict(int32_t index)
+{
+	for (int chnum = 0; chnum < CHANNELS_A; chnum++)
+		if (m_channel_a[chnum].m_cache == index)
+			m_channel_a[chnum].m_cache = -1;
+
+	free(m_cache_a[index].data);
+	m_cache_a_bytes -= m_cache_a[index].size * sizeof(uint32_t);
+	memset(&m_cache_a[index], 0, sizeof(adpcm_a_cache_entry));
+}
+
+
+//-------------------------------------------------
+//  cache_reserve - make room for more bytes within
+//  the budget by evicting the least recently used
+//  entries, other than the one being extended
+//-------------------------------------------------
+
+static bool adpcm_a_cache_reserve(uint32_t bytes, int32_t keep)
+{
+	while (m_cache_a_bytes + bytes > CACHE_A_BUDGET)
+	{
+		int32_t lru = -1;
+		for (int32_t i = 0; i < CACHE_A_ENTRIES; i++)
+			if (m_cache_a[i].data && i != keep &&
+				(lru < 0 || m_cache_a[i].used < m_cache_a[lru].used))
+				lru = i;
+
+		if (lru < 0)
+			return false;
+
+		adpcm_a_cache_evict(lru);
+	}
+	return true;
+}
+
+
+//-------------------------------------------------
+//  cache_attach - find or create the entry for a
+//  start address, returning -1 if none is available
+//-------------------------------------------------
+
+static int32_t adpcm_a_cache_attach(uint32_t start)
+{
+	int32_t index = -1, lru = -1;
+	for (int32_t i = 0; i < CACHE_A_ENTRIES; i++)
+	{
+		if (m_cache_a[i].data == NULL)
+		{
+			if (index < 0)
+				index = i;
+		}
+		else if (m_cache_a[i].start == start)
+		{
+			m_cache_a[i].used = ++m_cache_a_stamp;
+			return i;
+		}
+		else if (lru < 0 || m_cache_a[i].used < m_cache_a[lru].used)
+			lru = i;
+	}
+
+	// all entries in use, so replace the least recently used
+	if (index < 0)
+	{
+		index = lru;
+		adpcm_a_cache_evict(index);
+	}
+
+	if (!adpcm_a_cache_reserve(CACHE_A_MINSIZE * sizeof(uint32_t), index))
+		return -1;
+
+	m_cache_a[index].data = (uint32_t*)malloc(CACHE_A_MINSIZE * sizeof(uint32_t));
+	if (m_cache_a[index].data == NULL)
+		return -1;
+
+	m_cache_a_bytes += CACHE_A_MINSIZE * sizeof(uint32_t);
+	m_cache_a[index].start = start;
+	m_cache_a[index].len = 0;
+	m_cache_a[index].size = CACHE_A_MINSIZE;
+	m_cache_a[index].used = ++m_cache_a_stamp;
+	return index;
+}
+
+
+//-------------------------------------------------
+//  cache_append - record the state after a newly
+//  decoded nibble, growing the entry as needed
+//-------------------------------------------------
+
+static void adpcm_a_cache_append(uint32_t choffs)
+{
+	int32_t index = m_channel_a[choffs].m_cache;
+	adpcm_a_cache_entry *entry = &m_cache_a[index];
+
+	// only the channel furthest into the sample extends it
+	if (m_channel_a[choffs].m_cachepos != entry->len)
+	{
+		m_channel_a[choffs].m_cache = -1;
+		return;
+	}
+
+	if (entry->len == entry->size)
+	{
+		uint32_t *data = NULL;
+		if (adpcm_a_cache_reserve(entry->size * sizeof(uint32_t), index))
+			data = (uint32_t*)realloc(entry->data, entry->size * 2 * sizeof(uint32_t));
+
+		if (data == NULL)
+		{
+			m_channel_a[choffs].m_cache = -1;
+			return;
+		}
+
+		m_cache_a_bytes += entry->size * sizeof(uint32_t);
+		entry->data = data;
+		entry->size *= 2;
+	}
+
+	entry->data[entry->len++] = (m_channel_a[choffs].m_curbyte << 24) |
+		(m_channel_a[choffs].m_step_index << 12) |
+		(m_channel_a[choffs].m_accumulator & 0xfff);
+	m_channel_a[choffs].m_cachepos++;
+}
+
+
+//-------------------------------------------------
+//  cache_invalidate - discard all decoded samples
+//-------------------------------------------------
+
+void adpcm_a_cache_invalidate(void)
+{
+	if (m_cache_a_bytes == 0)
+		return;
+
+	for (int32_t i = 0; i < CACHE_A_ENTRIES; i++)
+		if (m_cache_a[i].data)
+			adpcm_a_cache_evict(i);
 }
 
 
@@ -175,6 +372,7 @@ static inline void adpcm_a_channel_keyonoff(uint32_t choffs, bool on)
 {
 	// QUESTION: repeated key ons restart the sample?
 	m_channel_a[choffs].m_playing = on;
+	m_active_a |= 1 << choffs;
 	if (m_channel_a[choffs].m_playing)
 	{
 		m_channel_a[choffs].m_curaddress =
@@ -184,7 +382,12 @@ static inline void adpcm_a_channel_keyonoff(uint32_t choffs, bool on)
 		m_channel_a[choffs].m_curbyte = 0;
 		m_channel_a[choffs].m_accumulator = 0;
 		m_channel_a[choffs].m_step_index = 0;
+		m_channel_a[choffs].m_cache =
+			adpcm_a_cache_attach(adpcm_a_registers_ch_start(m_channel_a[choffs].m_choffs));
+		m_channel_a[choffs].m_cachepos = 0;
 	}
+	else
+		m_channel_a[choffs].m_cache = -1;
 }
 
 
@@ -198,11 +401,11 @@ static inline bool adpcm_a_channel_clock(uint32_t choffs)
 	if (m_channel_a[choffs].m_playing == 0)
 	{
 		m_channel_a[choffs].m_accumulator = 0;
+		m_active_a &= ~(1 << choffs);
 		return false;
 	}
 
-	// if we're about to read nibble 0, fetch the data
-	uint8_t data;
+	// if we're about to read nibble 0, check for the end of the sample
 	if (m_channel_a[choffs].m_curnibble == 0)
 	{
 		// stop when we hit the end address; apparently only low 20 bits are used for
@@ -222,9 +425,31 @@ static inline bool adpcm_a_channel_clock(uint32_t choffs)
 			m_channel_a[choffs].m_playing = m_channel_a[choffs].m_accumulator = 0;
 			return true;
 		}
+	}
+
+	// replay the nibble if it was decoded by an earlier key on
+	int32_t cache = m_channel_a[choffs].m_cache;
+	if (cache >= 0 && m_channel_a[choffs].m_cachepos < m_cache_a[cache].len)
+	{
+		uint32_t state = m_cache_a[cache].data[m_channel_a[choffs].m_cachepos++];
+		if (m_channel_a[choffs].m_curnibble == 0)
+			m_channel_a[choffs].m_curaddress++;
+		m_channel_a[choffs].m_curnibble ^= 1;
+		m_channel_a[choffs].m_curbyte = state >> 24;
+		m_channel_a[choffs].m_step_index = (state >> 12) & 0x3f;
+		m_channel_a[choffs].m_accumulator = accum_wrap ? (int32_t)(state & 0xfff) :
+			(int32_t)((state & 0xfff) ^ 0x800) - 0x800;
+		return false;
+	}
 
-		m_channel_a[choffs].m_curbyte =
-			ymfm_external_read(ACCESS_ADPCM_A, m_channel_a[choffs].m_curaddress++);
+	// otherwise fetch the data if we're about to read nibble 0; only nibbles
+	// missing from the cache get this far, so the bounds check is off the
+	// replay path
+	uint8_t data;
+	if (m_channel_a[choffs].m_curnibble == 0)
+	{
+		uint32_t address = m_channel_a[choffs].m_curaddress++;
+		m_channel_a[choffs].m_curbyte = (address < m_rom_a_size) ? m_rom_a[address] : 0;
 		data = m_channel_a[choffs].m_curbyte >> 4;
 		m_channel_a[choffs].m_curnibble = 1;
 	}
@@ -266,6 +491,10 @@ static inline bool adpcm_a_channel_clock(uint32_t choffs)
 	m_channel_a[choffs].m_step_index =
 		clamp(m_channel_a[choffs].m_step_index + s_step_inc[bitfield(data, 0, 3)], 0, 48);
 
+	// record the result for later key ons of this sample
+	if (cache >= 0)
+		adpcm_a_cache_append(choffs);
+
 	return false;
 }
 
@@ -327,9 +556,13 @@ void adpcm_a_engine_reset(void)
 	// reset register state
 	adpcm_a_registers_reset();
 
+	// sample memory may have changed
+	adpcm_a_cache_invalidate();
+
 	// reset each channel
 	for (int i = 0; i < CHANNELS_A; ++i)
 		adpcm_a_channel_reset(i);
+	m_active_a = 0;
 }
 
 
@@ -339,6 +572,9 @@ void adpcm_a_engine_reset(void)
 
 uint32_t adpcm_a_engine_clock(uint32_t chanmask)
 {
+	// skip idle channels
+	chanmask &= m_active_a;
+
 	// clock each channel, setting a bit in result if it finished
 	uint32_t result = 0;
 	for (int chnum = 0; chnum < CHANNELS_A; chnum++)
@@ -357,8 +593,8 @@ uint32_t adpcm_a_engine_clock(uint32_t chanmask)
 
 void adpcm_a_engine_output(int32_t *output, uint32_t chanmask)
 {
-	// mask out some channels
-	chanmask &= 0xffffffff;
+	// mask out some channels, and idle ones which output 0
+	chanmask &= m_active_a;
 
 	// compute the output of each channel
 	for (int chnum = 0; chnum < CHANNELS_A; chnum++)
@@ -367,6 +603,17 @@ void adpcm_a_engine_output(int32_t *output, uint32_t chanmask)
 }
 
 
+//-------------------------------------------------
+//  active - return the mask of channels which
+//  need clocking and mixing
+//-------------------------------------------------
+
+uint32_t adpcm_a_engine_active(void)
+{
+	return m_active_a;
+}
+
+
 //-------------------------------------------------
 //  write - handle writes to the ADPCM-A registers
 //-------------------------------------------------
@@ -600,6 +847,17 @@ static inline bool adpcm_b_channel_at_end(void) {
 }
 
 
+//-------------------------------------------------
+//  rom_read - fetch a byte of sample memory, 0 at
+//  or past the end
+//-------------------------------------------------
+
+static inline uint8_t adpcm_b_rom_read(uint32_t address)
+{
+	return (address < m_rom_b_size) ? m_rom_b[address] : 0;
+}
+
+
 //-------------------------------------------------
 //  load_start - load the start address and
 //  initialize the state
@@ -643,7 +901,7 @@ static inline void adpcm_b_channel_clock(void)
 	{
 		// playing from RAM/ROM
 		if (adpcm_b_registers_external())
-			m_channel_b.m_curbyte = ymfm_external_read(ACCESS_ADPCM_B, m_channel_b.m_curaddress);
+			m_channel_b.m_curbyte = adpcm_b_rom_read(m_channel_b.m_curaddress);
 	}
 
 	// extract the nibble from our current byte
@@ -760,7 +1018,7 @@ static inline uint8_t adpcm_b_channel_read(uint32_t regnum)
 		else
 		{
 			// read from outside of the chip
-			result = ymfm_external_read(ACCESS_ADPCM_B, m_channel_b.m_curaddress++);
+			result = adpcm_b_rom_read(m_channel_b.m_curaddress++);
 
 			// did we hit the end? if so, signal EOS
 			if (adpcm_b_channel_at_end())
@@ -887,6 +1145,23 @@ void adpcm_b_engine_output(int32_t *output, uint32_t rshift)
 }
 
 
+//-------------------------------------------------
+//  idle - return true if the channel is stopped
+//  and outputs 0, so clocking and mixing it can be
+//  skipped until a register is written
+//-------------------------------------------------
+
+bool adpcm_b_engine_idle(void)
+{
+	if (m_channel_b.m_status & STATUS_PLAYING)
+		return false;
+
+	return (m_channel_b.m_accumulator == 0 && m_channel_b.m_prev_accum == 0) ||
+		adpcm_b_registers_level() == 0 ||
+		!(adpcm_b_registers_pan_left() | adpcm_b_registers_pan_right());
+}
+
+
 //-------------------------------------------------
 //  write - handle writes to the ADPCM-B registers
 //-------------------------------------------------
@@ -912,11 +1187,29 @@ uint8_t adpcm_b_engine_status(void) {
 }
 
 
+//-------------------------------------------------
+// sample memory
+//-------------------------------------------------
+
+void adpcm_a_set_rom(const uint8_t *rom, uint32_t size) {
+	adpcm_a_cache_invalidate();
+	m_rom_a = rom;
+	m_rom_a_size = rom ? size : 0;
+}
+
+void adpcm_b_set_rom(const uint8_t *rom, uint32_t size) {
+	m_rom_b = rom;
+	m_rom_b_size = rom ? size : 0;
+}
+
+
 //-------------------------------------------------
 // hacks
 //-------------------------------------------------
 
 void adpcm_a_set_accum_wrap(bool wrap) {
+	if (wrap != accum_wrap)
+		adpcm_a_cache_invalidate(); // decoded with the other behaviour
 	accum_wrap = wrap;
 }
 
@@ -942,7 +1235,12 @@ void adpcm_state_load(uint8_t *st) {
 		m_channel_a[i].m_curaddress = geo_serial_pop32(st);
 		m_channel_a[i].m_accumulator = geo_serial_pop32(st);
 		m_channel_a[i].m_step_index = geo_serial_pop32(st);
+		m_channel_a[i].m_cache = -1;
 	}
+	m_active_a = (1 << CHANNELS_A) - 1; // settled by the next clock
+
+	// sample memory may differ on the CD system
+	adpcm_a_cache_invalidate();
 
 	m_channel_b.m_address_shift = geo_serial_pop32(st);
 	m_channel_b.m_status = geo_serial_pop32(st);
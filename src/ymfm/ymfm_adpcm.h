@@ -49,16 +49,28 @@ uint32_t adpcm_a_engine_clock(uint32_t chanmask);
 // compute sum of channel outputs
 void adpcm_a_engine_output(int32_t *output, uint32_t chanmask);
 
+// mask of channels which are playing or not yet silent
+uint32_t adpcm_a_engine_active(void);
+
 // write to the ADPCM-A registers
 void adpcm_a_engine_write(uint32_t regnum, uint8_t data);
 
 // set accumulator wrapping on or off
 void adpcm_a_set_accum_wrap(bool wrap);
 
+// discard decoded samples, required when sample memory changes
+void adpcm_a_cache_invalidate(void);
+
+// set the sample memory, read in place and 0 at or past the end
+void adpcm_a_set_rom(const uint8_t *rom, uint32_t size);
+
 // ======================> adpcm_b_engine
 // init
 void adpcm_b_engine_init(void);
 
+// set the sample memory, read in place and 0 at or past the end
+void adpcm_b_set_rom(const uint8_t *rom, uint32_t size);
+
 // reset our status
 void adpcm_b_engine_reset(void);
 
@@ -68,6 +80,9 @@ void adpcm_b_engine_clock(void);
 // compute sum of channel outputs
 void adpcm_b_engine_output(int32_t *output, uint32_t rshift);
 
+// true if stopped with 0 output
+bool adpcm_b_engine_idle(void);
+
 // read from the ADPCM-B registers
 uint32_t adpcm_b_engine_read(uint32_t regnum);
 
@@ -91,6 +106,8 @@ typedef struct _adpcm_a_channel
 	uint32_t m_curaddress;                // current address
 	int32_t m_accumulator;                // accumulator
 	int32_t m_step_index;                 // index in the stepping table
+	int32_t m_cache;                      // decoded sample cache entry, or -1
+	uint32_t m_cachepos;                  // nibbles played since key on
 } adpcm_a_channel;
 
 // ======================> adpcm_b_channel
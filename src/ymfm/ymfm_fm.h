@@ -171,6 +171,9 @@ uint32_t fm_engine_clock(uint32_t chanmask);
 // compute sum of channel outputs
 void fm_engine_output(int32_t *output, uint32_t rshift, int32_t clipmax, uint32_t chanmask);
 
+// true if all channels in the mask are released and not being clocked
+bool fm_engine_idle(uint32_t chanmask);
+
 // write to the OPN registers
 void fm_engine_write(uint16_t regnum, uint8_t data);
 
@@ -57,9 +57,15 @@ static uint8_t m_dac_enable;            // DAC enabled?
 
 
 // ======================> ssg_resampler
-static void (*ssg_resampler_resample)(int32_t*);
+#define SSG_BLOCK_SAMPLES 256 // output samples resampled per SSG render
+
+static void (*ssg_resampler_resample)(int32_t*, uint32_t);
 static uint32_t m_ssg_resampler_sampindex;
-static int32_t m_ssg_resampler_last[3];
+static int32_t m_ssg_resampler_last;         // summed output of the last clock
+static int32_t m_ssg_resampler_clocks[SSG_BLOCK_SAMPLES * 9 / 2 + 1];
+
+// ======================> activity
+static uint32_t m_idle[YM2610_IDLE_ENGINES]; // samples each engine was skipped
 
 // return a bitfield extracted from a byte
 static inline uint32_t byte(uint32_t offset, uint32_t start, uint32_t count, uint32_t extra_offset)
@@ -587,97 +593,138 @@ void opn_state_save(uint8_t *st) {
 //*********************************************************
 
 //-------------------------------------------------
-//  add_last - helper to add the last computed
-//  value to the sums, applying the given scale
+//  resample_2_1 - resample SSG output to the
+//  target at a rate of 1 SSG sample to every
+//  2 output samples
 //-------------------------------------------------
 
-static inline void ssg_resampler_add_last(int32_t *sum0, int32_t *sum1, int32_t *sum2, int32_t scale)
+static void ssg_resampler_resample_2_1(int32_t *output, uint32_t samples)
 {
-	*sum0 += m_ssg_resampler_last[0] * scale;
-	*sum1 += m_ssg_resampler_last[1] * scale;
-	*sum2 += m_ssg_resampler_last[2] * scale;
-}
+	int32_t *clocks = m_ssg_resampler_clocks;
+	while (samples)
+	{
+		uint32_t count = samples < SSG_BLOCK_SAMPLES ? samples : SSG_BLOCK_SAMPLES;
+		samples -= count;
 
+		// the SSG is clocked on even samples
+		uint32_t index = m_ssg_resampler_sampindex;
+		uint32_t numclocks = (count + 1 - (index & 1)) >> 1;
+		if (!ssg_engine_render(clocks, numclocks))
+		{
+			// silent: only a sample held from the previous block is audible
+			if (index & 1)
+			{
+				output[2] = m_ssg_resampler_last * 2 / 3;
+				output += 3;
+			}
+			for (uint32_t i = index & 1; i < count; i++, output += 3)
+				output[2] = 0;
+			m_ssg_resampler_last = 0;
+			m_ssg_resampler_sampindex = index + count;
+			m_idle[YM2610_IDLE_SSG] += count;
+			continue;
+		}
 
-//-------------------------------------------------
-//  clock_and_add - helper to clock a new value
-//  and then add it to the sums, applying the
-//  given scale
-//-------------------------------------------------
+		const int32_t *clock = clocks;
+		for (; count; count--, output += 3, index++)
+		{
+			if ((index & 1) == 0)
+				m_ssg_resampler_last = *clock++;
 
-static inline void ssg_resampler_clock_and_add(int32_t *sum0, int32_t *sum1, int32_t *sum2, int32_t scale)
-{
-	ssg_engine_clock();
-	ssg_engine_output(m_ssg_resampler_last);
-	ssg_resampler_add_last(sum0, sum1, sum2, scale);
+			// mixing to one, apply a 2/3 factor to prevent overflow
+			output[2] = m_ssg_resampler_last * 2 / 3;
+		}
+		m_ssg_resampler_sampindex = index;
+	}
 }
 
 
 //-------------------------------------------------
-//  write_to_output - helper to write the sums to
-//  the appropriate outputs, applying the given
-//  divisor to the final result
+//  resample_2_9 - resample SSG output to the
+//  target at a rate of 9 SSG samples to every
+//  2 output samples
 //-------------------------------------------------
 
-static inline void ssg_resampler_write_to_output(int32_t *output, int32_t sum0, int32_t sum1, int32_t sum2, int32_t divisor)
+static void ssg_resampler_resample_2_9(int32_t *output, uint32_t samples)
 {
-	// mixing to one, apply a 2/3 factor to prevent overflow
-	output[2] = (sum0 + sum1 + sum2) * 2 / (3 * divisor);
-
-	// track the sample index here
-	m_ssg_resampler_sampindex++;
-}
+	int32_t *clocks = m_ssg_resampler_clocks;
+	while (samples)
+	{
+		uint32_t count = samples < SSG_BLOCK_SAMPLES ? samples : SSG_BLOCK_SAMPLES;
+		samples -= count;
 
+		// even samples take 5 clocks, odd samples 4, with the 5th clock of an
+		// even sample shared by the odd sample after it
+		uint32_t index = m_ssg_resampler_sampindex;
+		uint32_t numclocks = (count >> 1) * 9;
+		if (count & 1)
+			numclocks += (index & 1) ? 4 : 5;
 
-//-------------------------------------------------
-//  resample_2_1 - resample SSG output to the
-//  target at a rate of 1 SSG sample to every
-//  2 output samples
-//-------------------------------------------------
+		if (!ssg_engine_render(clocks, numclocks))
+		{
+			// silent: only a clock shared with the previous block is audible
+			if (index & 1)
+			{
+				output[2] = m_ssg_resampler_last * 2 / (3 * 9);
+				output += 3;
+			}
+			for (uint32_t i = index & 1; i < count; i++, output += 3)
+				output[2] = 0;
+			m_ssg_resampler_last = 0;
+			m_ssg_resampler_sampindex = index + count;
+			m_idle[YM2610_IDLE_SSG] += count;
+			continue;
+		}
 
-static void ssg_resampler_resample_2_1(int32_t *output)
-{
-	if (m_ssg_resampler_sampindex % 2 == 0)
-	{
-		ssg_engine_clock();
-		ssg_engine_output(m_ssg_resampler_last);
+		const int32_t *clock = clocks;
+		for (; count; count--, output += 3, index++)
+		{
+			int32_t sum;
+			if (index & 1)
+			{
+				sum = m_ssg_resampler_last + 2 * (clock[0] + clock[1] + clock[2] + clock[3]);
+				clock += 4;
+			}
+			else
+			{
+				sum = 2 * (clock[0] + clock[1] + clock[2] + clock[3]) + clock[4];
+				m_ssg_resampler_last = clock[4];
+				clock += 5;
+			}
+
+			// mixing to one, apply a 2/3 factor to prevent overflow
+			output[2] = sum * 2 / (3 * 9);
+		}
+		m_ssg_resampler_sampindex = index;
 	}
-	ssg_resampler_write_to_output(output, m_ssg_resampler_last[0],
-		m_ssg_resampler_last[1], m_ssg_resampler_last[2], 1);
 }
 
 
 //-------------------------------------------------
-//  resample_2_9 - resample SSG output to the
-//  target at a rate of 9 SSG samples to every
-//  2 output samples
+//  resample_nop - no-op resampler
 //-------------------------------------------------
 
-static void ssg_resampler_resample_2_9(int32_t *output)
+static void ssg_resampler_resample_nop(int32_t *output, uint32_t samples)
 {
-	int32_t sum0 = 0, sum1 = 0, sum2 = 0;
-	if (bitfield(m_ssg_resampler_sampindex, 0, 1) != 0)
-		ssg_resampler_add_last(&sum0, &sum1, &sum2, 1);
-	ssg_resampler_clock_and_add(&sum0, &sum1, &sum2, 2);
-	ssg_resampler_clock_and_add(&sum0, &sum1, &sum2, 2);
-	ssg_resampler_clock_and_add(&sum0, &sum1, &sum2, 2);
-	ssg_resampler_clock_and_add(&sum0, &sum1, &sum2, 2);
-	if (bitfield(m_ssg_resampler_sampindex, 0, 1) == 0)
-		ssg_resampler_clock_and_add(&sum0, &sum1, &sum2, 1);
-	ssg_resampler_write_to_output(output, sum0, sum1, sum2, 9);
+	if (output) { }
+
+	// nothing to do except increment the sample index
+	m_ssg_resampler_sampindex += samples;
 }
 
 
 //-------------------------------------------------
-//  resample_nop - no-op resampler
+//  ssg_resampler - Read/write resampler state data
 //-------------------------------------------------
 
-static void ssg_resampler_resample_nop(int32_t *output)
-{
-	if (output) { }
+void ssg_resampler_state_load(uint8_t *st) {
+	m_ssg_resampler_sampindex = geo_serial_pop32(st);
+	m_ssg_resampler_last = geo_serial_pop32(st);
+}
 
-	// nothing to do except increment the sample index
-	++m_ssg_resampler_sampindex;
+void ssg_resampler_state_save(uint8_t *st) {
+	geo_serial_push32(st, m_ssg_resampler_sampindex);
+	geo_serial_push32(st, m_ssg_resampler_last);
 }
 
 
@@ -689,7 +736,7 @@ static inline void ssg_resampler_init(void)
 {
 	m_ssg_resampler_sampindex = 0;
 	ssg_resampler_resample = &ssg_resampler_resample_nop;
-	m_ssg_resampler_last[0] = m_ssg_resampler_last[1] = m_ssg_resampler_last[2] = 0;
+	m_ssg_resampler_last = 0;
 }
 
 
@@ -1018,20 +1065,40 @@ void ym2610_write(uint32_t offset, uint8_t data)
 
 
 //-------------------------------------------------
-//  clock_fm_and_adpcm - clock FM and ADPCM state
+//  clock_state - clock FM and ADPCM state without
+//  computing any output, returning which ADPCM
+//  engines were idle for the output to skip
 //-------------------------------------------------
 
-static inline void ym2610_clock_fm_and_adpcm(void)
+#define YM2610_ADPCM_A_IDLE 1
+#define YM2610_ADPCM_B_IDLE 2
+
+static inline uint32_t ym2610_clock_state(void)
 {
+	uint32_t idle = 0;
+
 	// clock the system
 	uint32_t env_counter = fm_engine_clock(m_fm_mask);
+	if (fm_engine_idle(m_fm_mask))
+		m_idle[YM2610_IDLE_FM] += m_fm_samples_per_output;
 
 	// clock the ADPCM-A engine on every envelope cycle
-	if (bitfield(env_counter, 0, 2) == 0)
+	if (adpcm_a_engine_active() == 0)
+	{
+		idle |= YM2610_ADPCM_A_IDLE;
+		m_idle[YM2610_IDLE_ADPCM_A] += m_fm_samples_per_output;
+	}
+	else if (bitfield(env_counter, 0, 2) == 0)
 		m_eos_status |= adpcm_a_engine_clock(0x3f);
 
 	// clock the ADPCM-B engine every cycle
-	adpcm_b_engine_clock();
+	if (adpcm_b_engine_idle())
+	{
+		idle |= YM2610_ADPCM_B_IDLE;
+		m_idle[YM2610_IDLE_ADPCM_B] += m_fm_samples_per_output;
+	}
+	else
+		adpcm_b_engine_clock();
 
 	// we track the last ADPCM-B EOS value in bit 6 (which is hidden from callers);
 	// if it changed since the last sample, update the visible EOS state in bit 7
@@ -1039,13 +1106,27 @@ static inline void ym2610_clock_fm_and_adpcm(void)
 	if (((live_eos ^ m_eos_status) & 0x40) != 0)
 		m_eos_status = (m_eos_status & ~0xc0) | live_eos | (live_eos << 1);
 
+	return idle;
+}
+
+
+//-------------------------------------------------
+//  clock_fm_and_adpcm - clock FM and ADPCM state
+//-------------------------------------------------
+
+static inline void ym2610_clock_fm_and_adpcm(void)
+{
+	uint32_t idle = ym2610_clock_state();
+
 	// update the FM content; OPNB is 13-bit with no intermediate clipping
 	m_last_fm[0] = m_last_fm[1] = m_last_fm[2] = 0;
 	fm_engine_output(m_last_fm, 1, 32767, m_fm_mask);
 
 	// mix in the ADPCM and clamp
-	adpcm_a_engine_output(m_last_fm, 0x3f);
-	adpcm_b_engine_output(m_last_fm, 1);
+	if (!(idle & YM2610_ADPCM_A_IDLE))
+		adpcm_a_engine_output(m_last_fm, 0x3f);
+	if (!(idle & YM2610_ADPCM_B_IDLE))
+		adpcm_b_engine_output(m_last_fm, 1);
 
 	m_last_fm[0] = clamp(m_last_fm[0], -32768, 32767);
 	m_last_fm[1] = clamp(m_last_fm[1], -32768, 32767);
@@ -1059,14 +1140,99 @@ static inline void ym2610_clock_fm_and_adpcm(void)
 
 void ym2610_generate(int32_t *output)
 {
-	// FM output is just repeated the prescale number of times
-	if (m_ssg_resampler_sampindex % m_fm_samples_per_output == 0)
-		ym2610_clock_fm_and_adpcm();
-	output[0] = m_last_fm[0];
-	output[1] = m_last_fm[1];
-
-	// resample the SSG as configured
-	ssg_resampler_resample(output);
+	ym2610_generate_block(output, 1);
+}
+
+
+//-------------------------------------------------
+//  generate_block - generate a run of samples
+//  into output, 3 values (FM left, FM right, SSG)
+//  per sample; identical to calling generate for
+//  each one
+//-------------------------------------------------
+
+void ym2610_generate_block(int32_t *output, uint32_t samples)
+{
+	int32_t *out = output;
+
+	if (m_fm_samples_per_output == 1)
+	{
+		// FM and ADPCM are clocked for every output sample
+		for (uint32_t i = 0; i < samples; ++i, out += 3)
+		{
+			ym2610_clock_fm_and_adpcm();
+			out[0] = m_last_fm[0];
+			out[1] = m_last_fm[1];
+		}
+	}
+	else
+	{
+		// FM output is just repeated the prescale number of times
+		uint32_t index = m_ssg_resampler_sampindex;
+		for (uint32_t i = 0; i < samples; ++i, ++index, out += 3)
+		{
+			if (index % m_fm_samples_per_output == 0)
+				ym2610_clock_fm_and_adpcm();
+			out[0] = m_last_fm[0];
+			out[1] = m_last_fm[1];
+		}
+	}
+
+	// the SSG is independent of the FM and ADPCM engines, so it is rendered
+	// and resampled for the whole block in one pass
+	ssg_resampler_resample(output, samples);
+}
+
+
+//-------------------------------------------------
+//  clock_block - advance a run of samples without
+//  generating any sound; FM envelopes, ADPCM
+//  playback and the end of sample flags move on
+//  as they would when generating
+//-------------------------------------------------
+
+void ym2610_clock_block(uint32_t samples)
+{
+	if (m_fm_samples_per_output == 1)
+	{
+		for (uint32_t i = 0; i < samples; ++i)
+			ym2610_clock_state();
+	}
+	else
+	{
+		uint32_t index = m_ssg_resampler_sampindex;
+		for (uint32_t i = 0; i < samples; ++i, ++index)
+		{
+			if (index % m_fm_samples_per_output == 0)
+				ym2610_clock_state();
+		}
+	}
+
+	// the SSG counters are part of the saved state, so they are clocked as
+	// usual and the output is dropped
+	static int32_t scratch[SSG_BLOCK_SAMPLES * 3];
+	while (samples)
+	{
+		uint32_t count = samples < SSG_BLOCK_SAMPLES ? samples : SSG_BLOCK_SAMPLES;
+		samples -= count;
+		ssg_resampler_resample(scratch, count);
+	}
+}
+
+
+//-------------------------------------------------
+//  get_idle - copy out and clear the number of
+//  samples for which each engine had nothing to
+//  do and was skipped
+//-------------------------------------------------
+
+void ym2610_get_idle(uint32_t *idle)
+{
+	for (int i = 0; i < YM2610_IDLE_ENGINES; i++)
+	{
+		idle[i] = m_idle[i];
+		m_idle[i] = 0;
+	}
 }
 
 
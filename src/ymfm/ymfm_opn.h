@@ -155,9 +155,20 @@ uint32_t opn_registers_compute_phase_step(uint32_t choffs, const opdata_cache *c
 
 void opn_state_load(uint8_t *st);
 void opn_state_save(uint8_t *st);
+void ssg_resampler_state_load(uint8_t *st);
+void ssg_resampler_state_save(uint8_t *st);
 
 // ======================> ym2610/ym2610b
 
+// engines counted by ym2610_get_idle
+enum {
+	YM2610_IDLE_FM,
+	YM2610_IDLE_ADPCM_A,
+	YM2610_IDLE_ADPCM_B,
+	YM2610_IDLE_SSG,
+	YM2610_IDLE_ENGINES
+};
+
 void ym2610_init(void);
 void ym2610_set_fidelity(uint32_t fidelity);
 void ym2610_reset(void);
@@ -167,6 +178,9 @@ void ym2610_invalidate_caches(void);
 uint8_t ym2610_read(uint32_t offset);
 void ym2610_write(uint32_t offset, uint8_t data);
 void ym2610_generate(int32_t *output);
+void ym2610_generate_block(int32_t *output, uint32_t samples);
+void ym2610_clock_block(uint32_t samples);
+void ym2610_get_idle(uint32_t *idle);
 
 
 // ======================> ym2612
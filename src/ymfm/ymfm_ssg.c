@@ -37,6 +37,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ymfm_ssg.h"
 
 #define REGISTERS_SSG 0x10
+#define SSG_SKIP_MIN 8 // clocks without an audible edge worth stepping over
 
 // internal state
 static uint32_t m_tone_count[3];             // current tone counter
@@ -235,6 +236,36 @@ void ssg_engine_clock(void)
 	}
 }
 
+//-------------------------------------------------
+//  envelope_held - return true if the envelope
+//  has finished and holds its final volume
+//-------------------------------------------------
+
+static inline bool ssg_engine_envelope_held(void)
+{
+	return (ssg_registers_envelope_hold() | (ssg_registers_envelope_continue() ^ 1)) && m_envelope_state >= 32;
+}
+
+
+//-------------------------------------------------
+//  envelope_volume - compute the current envelope
+//  volume, pinning the state once it is held
+//-------------------------------------------------
+
+static inline uint32_t ssg_engine_envelope_volume(void)
+{
+	if (ssg_engine_envelope_held())
+	{
+		m_envelope_state = 32;
+		return ((ssg_registers_envelope_attack() ^ ssg_registers_envelope_alternate()) & ssg_registers_envelope_continue()) ? 31 : 0;
+	}
+
+	uint32_t attack = ssg_registers_envelope_attack();
+	if (ssg_registers_envelope_alternate())
+		attack ^= bitfield(m_envelope_state, 5, 1);
+	return (m_envelope_state & 31) ^ (attack ? 0 : 31);
+}
+
 //-------------------------------------------------
 //  output - output the current state
 //-------------------------------------------------
@@ -252,19 +283,7 @@ void ssg_engine_output(int32_t *output)
 	};
 
 	// compute the envelope volume
-	uint32_t envelope_volume;
-	if ((ssg_registers_envelope_hold() | (ssg_registers_envelope_continue() ^ 1)) && m_envelope_state >= 32)
-	{
-		m_envelope_state = 32;
-		envelope_volume = ((ssg_registers_envelope_attack() ^ ssg_registers_envelope_alternate()) & ssg_registers_envelope_continue()) ? 31 : 0;
-	}
-	else
-	{
-		uint32_t attack = ssg_registers_envelope_attack();
-		if (ssg_registers_envelope_alternate())
-			attack ^= bitfield(m_envelope_state, 5, 1);
-		envelope_volume = (m_envelope_state & 31) ^ (attack ? 0 : 31);
-	}
+	uint32_t envelope_volume = ssg_engine_envelope_volume();
 
 	// iterate over channels
 	for (int chan = 0; chan < 3; chan++)
@@ -298,6 +317,167 @@ void ssg_engine_output(int32_t *output)
 	}
 }
 
+static inline uint32_t ssg_min(uint32_t a, uint32_t b)
+{
+	return a < b ? a : b;
+}
+
+
+//-------------------------------------------------
+//  next_edge - return the number of clocks until
+//  a counter reaches its threshold and resets
+//-------------------------------------------------
+
+static inline uint32_t ssg_engine_next_edge(uint32_t count, uint32_t threshold)
+{
+	return threshold > count ? threshold - count : 1;
+}
+
+
+//-------------------------------------------------
+//  edges - advance a counter by the given number
+//  of clocks, returning how many times it reset
+//-------------------------------------------------
+
+static inline uint32_t ssg_engine_edges(uint32_t *count, uint32_t threshold, uint32_t clocks)
+{
+	uint32_t first = ssg_engine_next_edge(*count, threshold);
+	if (clocks < first)
+	{
+		*count += clocks;
+		return 0;
+	}
+
+	// after the first reset the counter runs from 0 to the threshold
+	uint32_t period = threshold ? threshold : 1;
+	clocks -= first;
+	*count = clocks % period;
+	return 1 + clocks / period;
+}
+
+
+//-------------------------------------------------
+//  noise_threshold - return the noise counter
+//  value which steps the noise generator; periods
+//  of 0 and 1 behave the same (see clock)
+//-------------------------------------------------
+
+static inline uint32_t ssg_engine_noise_threshold(void)
+{
+	uint32_t period = ssg_registers_noise_period();
+	return period > 1 ? period << 1 : 2;
+}
+
+
+//-------------------------------------------------
+//  skip - advance the state by the given number
+//  of clocks without computing any output; the
+//  result is identical to calling clock for each
+//-------------------------------------------------
+
+static void ssg_engine_skip(uint32_t clocks)
+{
+	for (int chan = 0; chan < 3; chan++)
+		m_tone_state[chan] ^= ssg_engine_edges(&m_tone_count[chan], ssg_registers_ch_tone_period(chan), clocks) & 1;
+
+	uint32_t steps = ssg_engine_edges(&m_noise_count, ssg_engine_noise_threshold(), clocks);
+	for (; steps; steps--)
+	{
+		m_noise_state ^= (bitfield(m_noise_state, 0, 1) ^ bitfield(m_noise_state, 3, 1)) << 17;
+		m_noise_state >>= 1;
+	}
+
+	m_envelope_state += ssg_engine_edges(&m_envelope_count, ssg_registers_envelope_period(), clocks);
+}
+
+
+//-------------------------------------------------
+//  render - clock the engine the given number of
+//  times, writing the sum of the channel outputs
+//  after each clock; the output only changes at
+//  tone, noise and envelope edges, so the state
+//  steps directly from one edge that can be heard
+//  to the next; returns false without writing
+//  anything if every channel is silent
+//-------------------------------------------------
+
+bool ssg_engine_render(int32_t *output, uint32_t clocks)
+{
+	// find which counters can affect the output
+	bool held = ssg_engine_envelope_held();
+	uint32_t tone = 0, noise = 0, envelope = 0;
+	bool audible = false;
+	for (int chan = 0; chan < 3; chan++)
+	{
+		if (ssg_registers_ch_envelope_enable(chan))
+		{
+			if (held && ssg_engine_envelope_volume() == 0)
+				continue;
+			envelope |= !held;
+		}
+		else if (ssg_registers_ch_amplitude(chan) == 0)
+			continue;
+
+		audible = true;
+		if (!ssg_registers_ch_tone_enable_n(chan))
+			tone |= 1 << chan;
+		if (!ssg_registers_ch_noise_enable_n(chan))
+			noise = 1;
+	}
+
+	// fast path for silence: just advance the state
+	if (!audible)
+	{
+		ssg_engine_skip(clocks);
+		ssg_engine_envelope_volume();
+		return false;
+	}
+
+	int32_t out[3];
+	ssg_engine_output(out);
+	int32_t sum = out[0] + out[1] + out[2];
+	while (clocks)
+	{
+		// find the next clock with an audible edge
+		uint32_t next = UINT32_MAX;
+		for (int chan = 0; chan < 3; chan++)
+			if (bitfield(tone, chan, 1))
+				next = ssg_min(next, ssg_engine_next_edge(m_tone_count[chan], ssg_registers_ch_tone_period(chan)));
+		if (noise)
+			next = ssg_min(next, ssg_engine_next_edge(m_noise_count, ssg_engine_noise_threshold()));
+		if (envelope)
+			next = ssg_min(next, ssg_engine_next_edge(m_envelope_count, ssg_registers_envelope_period()));
+
+		// the output holds until then
+		uint32_t run = next - 1 < clocks ? next - 1 : clocks;
+		if (run)
+		{
+			// short runs are cheaper to clock through than to step over
+			if (run < SSG_SKIP_MIN)
+				for (uint32_t i = 0; i < run; i++)
+					ssg_engine_clock();
+			else
+				ssg_engine_skip(run);
+			clocks -= run;
+			for (; run; run--)
+				*output++ = sum;
+			if (!clocks)
+				break;
+		}
+
+		// clock through the edge
+		ssg_engine_clock();
+		ssg_engine_output(out);
+		sum = out[0] + out[1] + out[2];
+		*output++ = sum;
+		clocks--;
+	}
+
+	// pin the envelope state as clocking through each output would have
+	ssg_engine_envelope_volume();
+	return true;
+}
+
 //-------------------------------------------------
 //  read - handle reads from the SSG registers
 //-------------------------------------------------
@@ -48,6 +48,9 @@ void ssg_engine_clock(void);
 // compute sum of channel outputs
 void ssg_engine_output(int32_t *output);
 
+// clock a block, writing the summed output per clock; false if silent
+bool ssg_engine_render(int32_t *output, uint32_t clocks);
+
 void ssg_state_load(uint8_t *st);
 void ssg_state_save(uint8_t *st);
 